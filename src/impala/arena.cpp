@@ -0,0 +1,47 @@
+#include "impala/arena.h"
+
+namespace impala {
+
+Arena*& Arena::current() {
+    static thread_local Arena* arena = nullptr;
+    return arena;
+}
+
+void Arena::adopt(Arena& other) {
+    for (auto& block : other.blocks_)
+        blocks_.emplace_back(std::move(block));
+    num_allocations_ += other.num_allocations_;
+    num_bytes_       += other.num_bytes_;
+
+    other.blocks_.clear();
+    other.cur_ = other.end_ = nullptr;
+    other.num_allocations_ = other.num_bytes_ = 0;
+}
+
+void Arena::rewind(const Mark& mark) {
+    blocks_.resize(mark.num_blocks);
+    cur_ = mark.cur;
+    end_ = mark.end;
+    num_allocations_ = mark.num_allocations;
+    num_bytes_       = mark.num_bytes;
+}
+
+void* Arena::grow(size_t size) {
+    ++num_allocations_;
+
+    if (size > block_size / 4) {
+        // give large requests a block of their own and keep bumping in the current one
+        blocks_.emplace_back(new char[size]);
+        num_bytes_ += size;
+        return blocks_.back().get();
+    }
+
+    blocks_.emplace_back(new char[block_size]);
+    num_bytes_ += block_size;
+    auto block = blocks_.back().get();
+    cur_ = block + size;
+    end_ = block + block_size;
+    return block;
+}
+
+}
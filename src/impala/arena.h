@@ -0,0 +1,92 @@
+#ifndef IMPALA_ARENA_H
+#define IMPALA_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace impala {
+
+/**
+ * Bump allocator for @p ASTNode%s and the types of a @p TypeTable.
+ * Individual allocations are never freed; all memory is released in bulk when the @p Arena is destroyed.
+ * Hence, an @p Arena must outlive every node allocated from it.
+ */
+class Arena {
+public:
+    static constexpr size_t block_size = 64 * 1024;
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        auto p = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~uintptr_t(align - 1);
+        if (cur_ == nullptr || p + size > reinterpret_cast<uintptr_t>(end_))
+            return grow(size);
+        cur_ = reinterpret_cast<char*>(p + size);
+        ++num_allocations_;
+        return reinterpret_cast<void*>(p);
+    }
+
+    /// Gives back the most recent allocation @p p of @p size bytes; does nothing if it is not the most recent one.
+    void free_last(void* p, size_t size) {
+        if (static_cast<char*>(p) + size == cur_) {
+            cur_ = static_cast<char*>(p);
+            --num_allocations_;
+        }
+    }
+
+    /// Takes over all memory of @p other which must not be used for allocations anymore.
+    void adopt(Arena& other);
+
+    /// A position to go back to with @p rewind.
+    struct Mark {
+        size_t num_blocks;
+        char* cur;
+        char* end;
+        size_t num_allocations;
+        size_t num_bytes;
+    };
+
+    Mark mark() const { return {blocks_.size(), cur_, end_, num_allocations_, num_bytes_}; }
+    /// Releases everything allocated since @p mark without running any destructors.
+    void rewind(const Mark& mark);
+
+    size_t num_allocations() const { return num_allocations_; }
+    size_t num_blocks() const { return blocks_.size(); }
+    size_t num_bytes() const { return num_bytes_; } ///< Size of all blocks.
+
+    /// The @p Arena new @p ASTNode%s are allocated from on this thread - see @p ArenaScope.
+    static Arena*& current();
+
+private:
+    void* grow(size_t size);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    size_t num_allocations_ = 0;
+    size_t num_bytes_ = 0;
+};
+
+/// Makes an @p Arena the @p Arena::current one on this thread during its lifetime.
+class ArenaScope {
+public:
+    ArenaScope(Arena& arena)
+        : old_(Arena::current())
+    {
+        Arena::current() = &arena;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ~ArenaScope() { Arena::current() = old_; }
+
+private:
+    Arena* old_;
+};
+
+}
+
+#endif
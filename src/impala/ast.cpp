@@ -1,17 +1,81 @@
 #include "impala/ast.h"
 
+#include <algorithm>
+#include <typeinfo>
+
+#include "impala/arena.h"
+#include "impala/session.h"
+#include "impala/stats.h"
+
 using namespace thorin;
 
 namespace impala {
 
-size_t ASTNode::gid_counter_ = 1;
-
 //------------------------------------------------------------------------------
 
-ASTNode::ASTNode(Loc loc)
-    : gid_(gid_counter_++)
-    , loc_(loc)
-{}
+ASTNode::ASTNode(SrcLoc loc)
+    : loc_(loc)
+{
+    if (auto nodes = unnumbered()) {
+        gid_ = 0;
+        nodes->push_back(this);
+    } else {
+        gid_ = session().ast_gid_counter++;
+        if (auto nodes = numbered())
+            nodes->push_back(this);
+    }
+
+    if (auto nodes = parsed())
+        nodes->push_back(this);
+}
+
+std::vector<const ASTNode*>*& ASTNode::parsed() {
+    static thread_local std::vector<const ASTNode*>* nodes = nullptr;
+    return nodes;
+}
+
+std::vector<ASTNode*>*& ASTNode::unnumbered() {
+    static thread_local std::vector<ASTNode*>* nodes = nullptr;
+    return nodes;
+}
+
+void ASTNode::number(const std::vector<ASTNode*>& nodes) {
+    for (auto node : nodes)
+        node->gid_ = session().ast_gid_counter++;
+    if (auto numbered_nodes = numbered())
+        numbered_nodes->insert(numbered_nodes->end(), nodes.begin(), nodes.end());
+}
+
+std::vector<const ASTNode*>*& ASTNode::numbered() {
+    static thread_local std::vector<const ASTNode*>* nodes = nullptr;
+    return nodes;
+}
+
+void* ASTNode::operator new(size_t size) { return ast_allocate(size); }
+void ASTNode::operator delete(void*) {} // the Arena releases the memory in bulk
+
+void* ast_allocate(size_t size) {
+    auto arena = Arena::current();
+    assert(arena != nullptr && "AST nodes must be created within an ArenaScope");
+    return arena->allocate(size);
+}
+
+void ASTNode::count(const std::vector<const ASTNode*>& nodes) {
+    size_t child_array_bytes = 0;
+    for (auto node : nodes) {
+        stats().count("AST nodes: " + demangle(typeid(*node).name()));
+
+        if (auto args = dynamic_cast<const Args*>(node))
+            child_array_bytes += args->num_args() * sizeof(Exprs::Child);
+        else if (auto tuple = node->isa<TuplePtrn>())
+            child_array_bytes += tuple->num_elems() * sizeof(Ptrns::Child);
+        else if (auto enum_ptrn = node->isa<EnumPtrn>())
+            child_array_bytes += enum_ptrn->num_args() * sizeof(Ptrns::Child);
+    }
+    stats().count("bytes of AST source locations", nodes.size() * sizeof(SrcLoc));
+    // the children themselves - the ChildArrays are part of their nodes
+    stats().count("bytes of AST child arrays", child_array_bytes);
+}
 
 const char* Visibility::str() {
     if (visibility_ == Pub)  return "pub ";
@@ -59,6 +123,36 @@ bool IfExpr::has_else() const {
     return true;
 }
 
+const std::unordered_set<const Item*>& Module::reachable_items() const {
+    if (reachable_items_computed_)
+        return reachable_items_;
+    reachable_items_computed_ = true;
+
+    std::vector<const Item*> queue;
+    auto reach = [&] (const Item* item) {
+        if (reachable_items_.emplace(item).second)
+            queue.push_back(item);
+    };
+
+    for (auto module : {library(), this}) {
+        if (module == nullptr) continue;
+        for (auto&& item : module->items()) {
+            auto fn_decl = item->isa<FnDecl>();
+            if (fn_decl == nullptr || fn_decl->is_extern() || fn_decl->symbol() == known_symbols().main)
+                reach(item.get());
+        }
+    }
+
+    while (!queue.empty()) {
+        auto item = queue.back();
+        queue.pop_back();
+        for (auto use : item->uses())
+            reach(use);
+    }
+
+    return reachable_items_;
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -157,7 +251,7 @@ const PrefixExpr* replace_rvalue_by_addrof(const RValueExpr* rvalue) {
     parent->release();
     auto src = rvalue->src()->back_ref_->release();
     src->back_ref_ = nullptr;
-    auto new_expr = new PrefixExpr(rvalue->loc(), PrefixExpr::AND, src);
+    auto new_expr = new PrefixExpr(rvalue->src_loc(), PrefixExpr::AND, src);
     delete rvalue;
     parent->reset(new_expr);
     new_expr->back_ref_ = parent;
@@ -1,6 +1,9 @@
 #ifndef IMPALA_AST_H
 #define IMPALA_AST_H
 
+#include <atomic>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "thorin/util/array.h"
@@ -41,9 +44,58 @@ class InferSema;
 class TypeSema;
 class CodeGen;
 
+/// Allocates @p size bytes from the current @p Arena - just like <tt>new</tt> for an @p ASTNode; there must be an @p ArenaScope.
+void* ast_allocate(size_t size);
+
+/**
+ * Fixed-size list of owned children which lives in the same @p Arena as its @p ASTNode.
+ * The @p Parser collects the children in a @p Builder; afterwards, the list never changes its size.
+ * Hence, the slots never move and may serve as @p Expr::back_ref_.
+ */
+template<class T>
+class ChildArray {
+public:
+    typedef std::unique_ptr<const T> Child;
+    typedef std::vector<Child> Builder;
+
+    ChildArray()
+        : size_(0)
+    {}
+    ChildArray(Builder&& children)
+        : size_(children.size())
+    {
+        if (size_ != 0) {
+            data_ = static_cast<Child*>(ast_allocate(size_ * sizeof(Child)));
+            std::uninitialized_move(children.begin(), children.end(), data_);
+        }
+    }
+    ChildArray(ChildArray&& other)
+        : data_(other.data_)
+        , size_(other.size_)
+    {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    ChildArray(const ChildArray&) = delete;
+    ChildArray& operator=(const ChildArray&) = delete;
+    ~ChildArray() { std::destroy_n(data_, size_); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const Child& operator[](size_t i) const { assert(i < size_); return data_[i]; }
+    const Child* begin() const { return data_; }
+    const Child* end() const { return data_ + size_; }
+    Child* begin() { return data_; }
+    Child* end() { return data_ + size_; }
+
+private:
+    Child* data_ = nullptr;
+    size_t size_;
+};
+
 typedef ArrayRef<std::unique_ptr<const ASTType>> ASTTypeArgs;
-typedef std::deque<std::unique_ptr<const Expr>> Exprs;
-typedef std::deque<std::unique_ptr<const Ptrn>> Ptrns;
+typedef ChildArray<Expr> Exprs;
+typedef ChildArray<Ptrn> Ptrns;
 typedef std::vector<Symbol> Symbols;
 typedef std::vector<const LocalDecl*> LocalDecls;
 typedef std::vector<std::string> Strings;
@@ -69,7 +121,7 @@ std::unique_ptr<const Expr> expr_;
 @endcode
 The constructor should look like this:
 @code{.cpp}
-MyExpr(Loc loc, ..., const Expr* expr, ...)
+MyExpr(SrcLoc loc, ..., const Expr* expr, ...)
     : Expr(loc)
     , ...
     , expr_(dock(expr_, expr))
@@ -134,18 +186,33 @@ public:
     ASTNode() = delete;
     ASTNode(const ASTNode&) = delete;
     ASTNode(ASTNode&&) = delete;
-    ASTNode(Loc loc);
-    virtual ~ASTNode() { assert(!loc_.file.empty()); }
+    ASTNode(SrcLoc loc);
+    virtual ~ASTNode() {}
 
     size_t gid() const { return gid_; }
-    Loc loc() const { return loc_; }
+    Loc loc() const { return loc_.loc(); }
+    SrcLoc src_loc() const { return loc_; }
     virtual Stream& stream(Stream&) const = 0;
 
-private:
-    static size_t gid_counter_;
+    /// If set, new nodes on this thread are recorded here as well - the @p Parser does so for <tt>-stats</tt>.
+    static std::vector<const ASTNode*>*& parsed();
+    /// Counts @p nodes by their class (see <tt>-stats</tt>).
+    static void count(const std::vector<const ASTNode*>& nodes);
+    /// If set, new nodes on this thread are collected here instead of getting a gid right away - see @p number.
+    static std::vector<ASTNode*>*& unnumbered();
+    /// Hands out gids to @p nodes in order.
+    static void number(const std::vector<ASTNode*>& nodes);
+    /// If set, nodes on this thread are recorded here as soon as they get their gid - see @p LibraryCache.
+    static std::vector<const ASTNode*>*& numbered();
 
+    /// @p ASTNode%s are allocated from the current @p Arena and released in bulk along with it - see @p ast_allocate.
+    /// Hence, <tt>delete</tt> only runs the destructor.
+    static void* operator new(size_t size);
+    static void operator delete(void* p);
+
+private:
     size_t gid_;
-    Loc loc_;
+    SrcLoc loc_;
 };
 
 template<class... Args>
@@ -155,12 +222,12 @@ void error  (const ASTNode* n, const char* fmt, Args... args) { error  (n->loc()
 
 class Identifier : public ASTNode {
 public:
-    Identifier(Loc loc, Symbol symbol)
+    Identifier(SrcLoc loc, Symbol symbol)
         : ASTNode(loc)
         , symbol_(symbol)
     {}
     Identifier(Token tok)
-        : ASTNode(tok.loc())
+        : ASTNode(tok.src_loc())
         , symbol_(tok.symbol())
     {}
 
@@ -173,13 +240,14 @@ private:
 
 class Typeable : public ASTNode {
 public:
-    Typeable(Loc loc) : ASTNode(loc) {}
+    Typeable(SrcLoc loc) : ASTNode(loc) {}
 
     const Type* type() const { return type_; }
 
 protected:
     mutable const Type* type_ = nullptr;
 
+    friend class CheckedLibrary;
     friend class InferSema;
 };
 
@@ -194,7 +262,7 @@ public:
     class Elem : public Typeable {
     public:
         Elem(const Identifier* id)
-            : Typeable(id->loc())
+            : Typeable(id->src_loc())
             , identifier_(id)
         {}
 
@@ -215,13 +283,13 @@ public:
 
     typedef std::deque<std::unique_ptr<const Elem>> Elems;
 
-    Path(Loc loc, bool global, Elems&& elems)
+    Path(SrcLoc loc, bool global, Elems&& elems)
         : Typeable(loc)
         , global_(global)
         , elems_(std::move(elems))
     {}
     Path(const Identifier* id)
-        : Path(id->loc(), false, Elems())
+        : Path(id->src_loc(), false, Elems())
     {
         elems_.emplace_back(new Elem(id));
     }
@@ -251,7 +319,7 @@ private:
 
 class ASTType : public Typeable {
 public:
-    ASTType(Loc loc)
+    ASTType(SrcLoc loc)
         : Typeable(loc)
     {}
 
@@ -267,7 +335,7 @@ private:
 
 class ErrorASTType : public ASTType {
 public:
-    ErrorASTType(Loc loc)
+    ErrorASTType(SrcLoc loc)
         : ASTType(loc)
     {}
 
@@ -286,7 +354,7 @@ public:
 #include "impala/tokenlist.h"
     };
 
-    PrimASTType(Loc loc, Tag tag)
+    PrimASTType(SrcLoc loc, Tag tag)
         : ASTType(loc)
         , tag_(tag)
     {}
@@ -307,7 +375,7 @@ class PtrASTType : public ASTType {
 public:
     enum Tag { Borrowed, Mut, Owned };
 
-    PtrASTType(Loc loc, Tag tag, int addr_space, const ASTType* referenced_ast_type)
+    PtrASTType(SrcLoc loc, Tag tag, int addr_space, const ASTType* referenced_ast_type)
         : ASTType(loc)
         , tag_(tag)
         , addr_space_(addr_space)
@@ -333,7 +401,7 @@ private:
 
 class ArrayASTType : public ASTType {
 public:
-    ArrayASTType(Loc loc, const ASTType* elem_ast_type)
+    ArrayASTType(SrcLoc loc, const ASTType* elem_ast_type)
         : ASTType(loc)
         , elem_ast_type_(elem_ast_type)
     {}
@@ -346,7 +414,7 @@ protected:
 
 class IndefiniteArrayASTType : public ArrayASTType {
 public:
-    IndefiniteArrayASTType(Loc loc, const ASTType* elem_ast_type)
+    IndefiniteArrayASTType(SrcLoc loc, const ASTType* elem_ast_type)
         : ArrayASTType(loc, elem_ast_type)
     {}
 
@@ -360,7 +428,7 @@ private:
 
 class DefiniteArrayASTType : public ArrayASTType {
 public:
-    DefiniteArrayASTType(Loc loc, const ASTType* elem_ast_type, uint64_t dim)
+    DefiniteArrayASTType(SrcLoc loc, const ASTType* elem_ast_type, uint64_t dim)
         : ArrayASTType(loc, elem_ast_type)
         , dim_(dim)
     {}
@@ -379,7 +447,7 @@ private:
 
 class CompoundASTType : public ASTType {
 public:
-    CompoundASTType(Loc loc, ASTTypes&& ast_type_args)
+    CompoundASTType(SrcLoc loc, ASTTypes&& ast_type_args)
         : ASTType(loc)
         , ast_type_args_(std::move(ast_type_args))
     {}
@@ -395,7 +463,7 @@ protected:
 
 class TupleASTType : public CompoundASTType {
 public:
-    TupleASTType(Loc loc, ASTTypes&& ast_type_args)
+    TupleASTType(SrcLoc loc, ASTTypes&& ast_type_args)
         : CompoundASTType(loc, std::move(ast_type_args))
     {}
 
@@ -409,12 +477,12 @@ private:
 
 class ASTTypeApp : public CompoundASTType {
 public:
-    ASTTypeApp(Loc loc, const Path* path, ASTTypes&& ast_type_args)
+    ASTTypeApp(SrcLoc loc, const Path* path, ASTTypes&& ast_type_args)
         : CompoundASTType(loc, std::move(ast_type_args))
         , path_(path)
     {}
 
-    ASTTypeApp(Loc loc, const Path* path)
+    ASTTypeApp(SrcLoc loc, const Path* path)
         : ASTTypeApp(loc, path, ASTTypes())
     {}
 
@@ -435,12 +503,12 @@ private:
 
 class FnASTType : public ASTTypeParamList, public CompoundASTType {
 public:
-    FnASTType(Loc loc, ASTTypeParams&& ast_type_params, ASTTypes&& ast_type_args)
+    FnASTType(SrcLoc loc, ASTTypeParams&& ast_type_params, ASTTypes&& ast_type_args)
         : ASTTypeParamList(std::move(ast_type_params))
         , CompoundASTType(loc, std::move(ast_type_args))
     {}
 
-    FnASTType(Loc loc, ASTTypes&& ast_type_args = ASTTypes())
+    FnASTType(SrcLoc loc, ASTTypes&& ast_type_args = ASTTypes())
         : ASTTypeParamList(ASTTypeParams())
         , CompoundASTType(loc, std::move(ast_type_args))
     {}
@@ -457,7 +525,7 @@ private:
 
 class Typeof : public ASTType {
 public:
-    Typeof(Loc loc, const Expr* expr)
+    Typeof(SrcLoc loc, const Expr* expr)
         : ASTType(loc)
         , expr_(dock(expr_, expr))
     {}
@@ -476,7 +544,7 @@ private:
 
 class SimdASTType : public ArrayASTType {
 public:
-    SimdASTType(Loc loc, const ASTType* elem_ast_type, uint64_t size)
+    SimdASTType(SrcLoc loc, const ASTType* elem_ast_type, uint64_t size)
         : ArrayASTType(loc, elem_ast_type)
         , size_(size)
     {}
@@ -511,24 +579,23 @@ public:
     };
 
     /// General constructor.
-    Decl(Tag tag, Loc loc, bool mut, const Identifier* id, const ASTType* ast_type)
+    Decl(Tag tag, SrcLoc loc, bool mut, const Identifier* id, const ASTType* ast_type)
         : Typeable(loc)
         , tag_(tag)
         , identifier_(id)
         , ast_type_(ast_type)
         , mut_(mut)
-        , written_(false)
     {}
     /// @p NoDecl.
-    Decl(Loc loc)
+    Decl(SrcLoc loc)
         : Decl(NoDecl, loc, false, nullptr, nullptr)
     {}
     /// @p TypeableDecl, @p TypeDecl or @p ValueDecl.
-    Decl(Tag tag, Loc loc, const Identifier* id)
+    Decl(Tag tag, SrcLoc loc, const Identifier* id)
         : Decl(tag, loc, false, id, nullptr)
     {}
     /// @p ValueDecl.
-    Decl(Loc loc, bool mut, const Identifier* id, const ASTType* ast_type)
+    Decl(SrcLoc loc, bool mut, const Identifier* id, const ASTType* ast_type)
         : Decl(ValueDecl, loc, mut, id, ast_type)
     {}
 
@@ -542,7 +609,7 @@ public:
     // identifier
     const Identifier* identifier() const { assert(!is_no_decl()); return identifier_.get(); }
     Symbol symbol() const { assert(!is_no_decl()); return identifier_->symbol(); }
-    bool is_anonymous() const { assert(!is_no_decl()); return symbol() == Symbol() || symbol().c_str()[0] == '<'; }
+    bool is_anonymous() const { assert(!is_no_decl()); return symbol().empty() || symbol().c_str()[0] == '<'; }
     size_t depth() const { assert(!is_no_decl()); return depth_; }
     const Decl* shadows() const { assert(!is_no_decl()); return shadows_; }
     thorin::Debug debug() const { return {symbol().str(), loc()}; }
@@ -564,7 +631,7 @@ protected:
     mutable const Decl* shadows_;
     mutable unsigned depth_   : 24;
     unsigned mut_             :  1;
-    mutable unsigned written_ :  1;
+    mutable std::atomic<bool> written_{false}; ///< not a bit-field - items are checked concurrently - see @p type_analysis
 
     friend class CodeGen;
     friend class NameSema;
@@ -573,10 +640,10 @@ protected:
 /// Base class for all values which may be mutated within a function.
 class LocalDecl : public Decl {
 public:
-    LocalDecl(Loc loc, bool mut, const Identifier* id, const ASTType* ast_type)
+    LocalDecl(SrcLoc loc, bool mut, const Identifier* id, const ASTType* ast_type)
         : Decl(loc, mut, id, ast_type)
     {}
-    LocalDecl(Loc loc, const Identifier* id, const ASTType* ast_type)
+    LocalDecl(SrcLoc loc, const Identifier* id, const ASTType* ast_type)
         : LocalDecl(loc, /*mut*/ false, id, ast_type)
     {}
 
@@ -608,7 +675,7 @@ protected:
 
 class ASTTypeParam : public Decl {
 public:
-    ASTTypeParam(Loc loc, const Identifier* id, ASTTypes&& bounds)
+    ASTTypeParam(SrcLoc loc, const Identifier* id, ASTTypes&& bounds)
         : Decl(TypeDecl, loc, id)
         , bounds_(std::move(bounds))
     {}
@@ -635,12 +702,12 @@ private:
 
 class Param : public LocalDecl {
 public:
-    Param(Loc loc, bool mut, const Identifier* id, const ASTType* ast_type, const Expr* filter = nullptr)
+    Param(SrcLoc loc, bool mut, const Identifier* id, const ASTType* ast_type, const Expr* filter = nullptr)
         : LocalDecl(loc, mut, id, ast_type)
         , filter_(dock(filter_, filter))
     {}
 
-    Param(Loc loc, const Identifier* id, const ASTType* ast_type, const Expr* filter = nullptr)
+    Param(SrcLoc loc, const Identifier* id, const ASTType* ast_type, const Expr* filter = nullptr)
         : Param(loc, /*mut*/ false, id, ast_type, filter)
     {}
 
@@ -686,6 +753,8 @@ protected:
 
 private:
     std::unique_ptr<const Expr> body_;
+
+    friend class CodeGen;
 };
 
 //------------------------------------------------------------------------------
@@ -697,24 +766,26 @@ private:
 class Item : public Decl {
 public:
     /// @p NoDecl.
-    Item(Loc loc, Visibility vis)
+    Item(SrcLoc loc, Visibility vis)
         : Decl(loc)
         , visibility_(vis)
     {}
 
     /// @p TypeableDecl, @p TypeDecl or @p ValueDecl.
-    Item(Tag tag, Loc loc, Visibility vis, const Identifier* id)
+    Item(Tag tag, SrcLoc loc, Visibility vis, const Identifier* id)
         : Decl(tag, loc, id)
         , visibility_(vis)
     {}
 
     /// @p ValueDecl.
-    Item(Loc loc, Visibility vis, bool mut, const Identifier* id, const ASTType* ast_type)
+    Item(SrcLoc loc, Visibility vis, bool mut, const Identifier* id, const ASTType* ast_type)
         : Decl(ValueDecl, loc, mut, id, ast_type)
         , visibility_(vis)
     {}
 
     Visibility visibility() const { return visibility_; }
+    /// Items referenced by name from within this top-level item, each once - collected by @p NameSema.
+    const std::vector<const Item*>& uses() const { return uses_; }
     virtual void bind(NameSema&) const = 0;
     virtual void emit_head(CodeGen&) const {};
     virtual void emit(CodeGen&) const = 0;
@@ -725,15 +796,17 @@ private:
     virtual void check(TypeSema&) const = 0;
 
     Visibility visibility_;
+    mutable std::vector<const Item*> uses_;
 
     friend class CodeGen;
     friend class InferSema;
+    friend class NameSema;
     friend class TypeSema;
 };
 
 class TypeDeclItem : public Item, public ASTTypeParamList {
 public:
-    TypeDeclItem(Loc loc, Visibility vis, const Identifier* id, ASTTypeParams&& ast_type_params)
+    TypeDeclItem(SrcLoc loc, Visibility vis, const Identifier* id, ASTTypeParams&& ast_type_params)
         : Item(TypeDecl, loc,  vis, id)
         , ASTTypeParamList(std::move(ast_type_params))
     {}
@@ -741,26 +814,40 @@ public:
 
 class ValueItem : public Item {
 public:
-    ValueItem(Loc loc, Visibility vis, bool mut, const Identifier* id, const ASTType* ast_type)
+    ValueItem(SrcLoc loc, Visibility vis, bool mut, const Identifier* id, const ASTType* ast_type)
         : Item(loc, vis, mut, id, ast_type)
     {}
 };
 
 class Module : public TypeDeclItem {
 public:
-    Module(Loc loc, Visibility vis, const Identifier* id, ASTTypeParams&& ast_type_params, Items&& items)
+    Module(SrcLoc loc, Visibility vis, const Identifier* id, ASTTypeParams&& ast_type_params, Items&& items)
         : TypeDeclItem(loc, vis, id, std::move(ast_type_params))
         , items_(std::move(items))
     {}
 
-    Module(const char* first_file_name, Items&& items = Items())
-        : Module(items.empty() ? Loc(first_file_name, {1, 1}, {1, 1}) 
-                               : Loc(items.front()->loc().file, items.front()->loc().begin, items.back()->loc().finis),
+    /// The items of a whole file; they may use all items of the @p library which must already be checked.
+    Module(const char* first_file_name, Items&& items = Items(), const Module* library = nullptr)
+        : Module(items.empty() ? SrcLoc(Loc(first_file_name, {1, 1}, {1, 1}))
+                               : SrcLoc(items.front()->src_loc().file, items.front()->src_loc().begin, items.back()->src_loc().finis),
                  Visibility::Pub, nullptr, ASTTypeParams(), std::move(items))
-    {}
+    {
+        library_ = library;
+    }
 
     const Items& items() const { return items_; }
+    /**
+     * The @p Module of the library files this one was compiled against - see @p LibraryCache - or @c nullptr.
+     * Only this @p Module's own @p items are inferred and checked again; name analysis and emission cover the @p library as well.
+     */
+    const Module* library() const { return library_; }
     const Symbol2Item& symbol2item() const { return symbol2item_; }
+    /**
+     * The roots - exported functions, @c main, and all items that are not functions - plus all items they transitively
+     * use, including those of the @p library. Computed on first demand after name analysis.
+     */
+    const std::unordered_set<const Item*>& reachable_items() const;
+    bool is_reachable(const Item* item) const { return reachable_items().count(item) != 0; }
 
     void bind(NameSema&) const override;
     void infer(InferSema&) const override;
@@ -771,12 +858,15 @@ public:
 
 private:
     Items items_;
+    const Module* library_ = nullptr;
     mutable Symbol2Item symbol2item_;
+    mutable std::unordered_set<const Item*> reachable_items_;
+    mutable bool reachable_items_computed_ = false;
 };
 
 class ModuleDecl : public TypeDeclItem {
 public:
-    ModuleDecl(Loc loc, Visibility vis, const Identifier* id, ASTTypeParams&& ast_type_params)
+    ModuleDecl(SrcLoc loc, Visibility vis, const Identifier* id, ASTTypeParams&& ast_type_params)
         : TypeDeclItem(loc, vis, id, std::move(ast_type_params))
     {}
 
@@ -792,7 +882,7 @@ private:
 
 class ExternBlock : public Item {
 public:
-    ExternBlock(Loc loc, Visibility vis, Symbol abi, FnDecls&& fn_decls)
+    ExternBlock(SrcLoc loc, Visibility vis, Symbol abi, FnDecls&& fn_decls)
         : Item(loc, vis)
         , abi_(abi)
         , fn_decls_(std::move(fn_decls))
@@ -817,7 +907,7 @@ private:
 
 class Typedef : public TypeDeclItem {
 public:
-    Typedef(Loc loc, Visibility vis, const Identifier* id,
+    Typedef(SrcLoc loc, Visibility vis, const Identifier* id,
             ASTTypeParams&& ast_type_params, const ASTType* ast_type)
         : TypeDeclItem(loc, vis, id, std::move(ast_type_params))
         , ast_type_(ast_type)
@@ -839,7 +929,7 @@ private:
 
 class FieldDecl : public Decl {
 public:
-    FieldDecl(Loc loc, size_t index, Visibility vis, const Identifier* id, const ASTType* ast_type)
+    FieldDecl(SrcLoc loc, size_t index, Visibility vis, const Identifier* id, const ASTType* ast_type)
         : Decl(TypeableDecl, loc, id)
         , index_(index)
         , visibility_(vis)
@@ -867,7 +957,7 @@ private:
 
 class StructDecl : public TypeDeclItem {
 public:
-    StructDecl(Loc loc, Visibility vis, const Identifier* id,
+    StructDecl(SrcLoc loc, Visibility vis, const Identifier* id,
                ASTTypeParams&& ast_type_params, FieldDecls&& field_decls)
         : TypeDeclItem(loc, vis, id, std::move(ast_type_params))
         , field_decls_(std::move(field_decls))
@@ -897,7 +987,7 @@ private:
 
 class OptionDecl : public Decl {
 public:
-    OptionDecl(Loc loc, size_t index, const Identifier* id, ASTTypes args)
+    OptionDecl(SrcLoc loc, size_t index, const Identifier* id, ASTTypes args)
         : Decl(ValueDecl, loc, id)
         , index_(index)
         , args_(std::move(args))
@@ -931,7 +1021,7 @@ private:
 
 class EnumDecl : public TypeDeclItem {
 public:
-    EnumDecl(Loc loc, Visibility vis, const Identifier* id,
+    EnumDecl(SrcLoc loc, Visibility vis, const Identifier* id,
              ASTTypeParams&& ast_type_params, OptionDecls&& option_decls)
         : TypeDeclItem(loc, vis, id, std::move(ast_type_params))
         , option_decls_(std::move(option_decls))
@@ -964,7 +1054,7 @@ private:
 
 class StaticItem : public ValueItem {
 public:
-    StaticItem(Loc loc, Visibility vis, bool mut, const Identifier* id,
+    StaticItem(SrcLoc loc, Visibility vis, bool mut, const Identifier* id,
                const ASTType* ast_type, const Expr* init)
         : ValueItem(loc, vis, mut, id, std::move(ast_type))
         , init_(dock(init_, init))
@@ -987,7 +1077,7 @@ private:
 
 class FnDecl : public ValueItem, public Fn {
 public:
-    FnDecl(Loc loc, Visibility vis, bool is_extern, Symbol abi, const Expr* filter, Symbol export_name,
+    FnDecl(SrcLoc loc, Visibility vis, bool is_extern, Symbol abi, const Expr* filter, Symbol export_name,
            const Identifier* id, ASTTypeParams&& ast_type_params, Params&& params, const Expr* body)
         : ValueItem(loc, vis, /*mut*/ false, id, /*ast_type*/ nullptr)
         , Fn(filter, std::move(ast_type_params), std::move(params), body)
@@ -1005,7 +1095,7 @@ public:
             t = lambda->body();
         return t->as<FnType>();
     }
-    Symbol fn_symbol() const override { return export_name_ != "" ? export_name_ : identifier()->symbol(); }
+    Symbol fn_symbol() const override { return !export_name_.empty() ? export_name_ : identifier()->symbol(); }
 
     void bind(NameSema&) const override;
     void emit_head(CodeGen&) const override;
@@ -1024,7 +1114,7 @@ private:
 
 class TraitDecl : public Item, public ASTTypeParamList {
 public:
-    TraitDecl(Loc loc, Visibility vis, const Identifier* id,
+    TraitDecl(SrcLoc loc, Visibility vis, const Identifier* id,
               ASTTypeParams&& ast_type_params, ASTTypeApps&& super_traits, FnDecls&& methods)
         : Item(TypeDecl, loc, vis, id)
         , ASTTypeParamList(std::move(ast_type_params))
@@ -1052,7 +1142,7 @@ private:
 
 class ImplItem : public Item, public ASTTypeParamList {
 public:
-    ImplItem(Loc loc, Visibility vis, ASTTypeParams&& ast_type_params,
+    ImplItem(SrcLoc loc, Visibility vis, ASTTypeParams&& ast_type_params,
              const ASTType* trait, const ASTType* ast_type, FnDecls&& methods)
         : Item(loc, vis)
         , ASTTypeParamList(std::move(ast_type_params))
@@ -1092,7 +1182,7 @@ private:
 
 class Expr : public Typeable {
 public:
-    Expr(Loc loc)
+    Expr(SrcLoc loc)
         : Typeable(loc)
     {}
 
@@ -1121,7 +1211,7 @@ protected:
     /**
      * A back reference to the @p std::unique_ptr which owns this @p Expr.
      * This means that the address is @em not supposed to be changed in the future.
-     * For this reason, @p Exprs is a <tt> std::deque<std::unique_ptr<const Expr>> </tt> and @em not a @c std::vector.
+     * For this reason, @p Exprs is a fixed @p ChildArray and @em not a @c std::vector.
      */
     mutable std::unique_ptr<const Expr>* back_ref_ = nullptr;
 
@@ -1181,7 +1271,7 @@ protected:
 
 class EmptyExpr : public Expr {
 public:
-    EmptyExpr(Loc loc)
+    EmptyExpr(SrcLoc loc)
         : Expr(loc)
     {}
 
@@ -1202,7 +1292,7 @@ public:
         LIT_bool,
     };
 
-    LiteralExpr(Loc loc, Tag tag, thorin::Box box)
+    LiteralExpr(SrcLoc loc, Tag tag, thorin::Box box)
         : Expr(loc)
         , tag_(tag)
         , box_(box)
@@ -1228,7 +1318,7 @@ private:
 
 class CharExpr : public Expr {
 public:
-    CharExpr(Loc loc, Symbol symbol, char value)
+    CharExpr(SrcLoc loc, Symbol symbol, char value)
         : Expr(loc)
         , symbol_(symbol)
         , value_(value)
@@ -1251,7 +1341,7 @@ private:
 
 class StrExpr : public Expr {
 public:
-    StrExpr(Loc loc, Symbols&& symbols, std::vector<char>&& values)
+    StrExpr(SrcLoc loc, Symbols&& symbols, std::vector<char>&& values)
         : Expr(loc)
         , symbols_(std::move(symbols))
         , values_(std::move(values))
@@ -1274,13 +1364,13 @@ private:
 
 class FnExpr : public Expr, public Fn {
 public:
-    FnExpr(Loc loc, const Expr* filter, Params&& params, const Expr* body)
+    FnExpr(SrcLoc loc, const Expr* filter, Params&& params, const Expr* body)
         : Expr(loc)
         , Fn(filter, ASTTypeParams(), std::move(params), body)
     {}
 
     const FnType* fn_type() const override { return type()->as<FnType>(); }
-    Symbol fn_symbol() const override { return Symbol("lambda"); }
+    Symbol fn_symbol() const override { return known_symbols().lambda; }
     void bind(NameSema&) const override;
     const thorin::Def* remit(CodeGen&) const override;
     Stream& stream(Stream&) const override;
@@ -1293,7 +1383,7 @@ private:
 class PathExpr : public Expr {
 public:
     PathExpr(const Path* path)
-        : Expr(path->loc())
+        : Expr(path->src_loc())
         , path_(path)
     {}
     PathExpr(const Identifier* identifier)
@@ -1327,14 +1417,14 @@ public:
         MUT
     };
 
-    PrefixExpr(Loc loc, Tag tag, const Expr* rhs)
+    PrefixExpr(SrcLoc loc, Tag tag, const Expr* rhs)
         : Expr(loc)
         , tag_(tag)
         , rhs_(dock(rhs_, rhs))
     {}
 
     static const PrefixExpr* create(const Expr* rhs, const Tag tag) {
-        return interlope<PrefixExpr>(rhs, rhs->loc(), tag, rhs);
+        return interlope<PrefixExpr>(rhs, rhs->src_loc(), tag, rhs);
     }
     static const PrefixExpr* create_deref(const Expr* rhs) { return create(rhs, MUL); }
     static const PrefixExpr* create_addrof(const Expr* rhs);
@@ -1365,7 +1455,7 @@ public:
 #include "impala/tokenlist.h"
     };
 
-    InfixExpr(Loc loc, const Expr* lhs, Tag tag, const Expr* rhs)
+    InfixExpr(SrcLoc loc, const Expr* lhs, Tag tag, const Expr* rhs)
         : Expr(loc)
         , tag_(tag)
         , lhs_(dock(lhs_, lhs))
@@ -1402,7 +1492,7 @@ public:
         DEC = Token::DEC
     };
 
-    PostfixExpr(Loc loc, const Expr* lhs, Tag tag)
+    PostfixExpr(SrcLoc loc, const Expr* lhs, Tag tag)
         : Expr(loc)
         , tag_(tag)
         , lhs_(dock(lhs_, lhs))
@@ -1426,7 +1516,7 @@ private:
 
 class FieldExpr : public Expr {
 public:
-    FieldExpr(Loc loc, const Expr* lhs, const Identifier* id)
+    FieldExpr(SrcLoc loc, const Expr* lhs, const Identifier* id)
         : Expr(loc)
         , lhs_(dock(lhs_, lhs))
         , identifier_(id)
@@ -1456,7 +1546,7 @@ private:
 
 class CastExpr : public Expr {
 public:
-    CastExpr(Loc loc, const Expr* src)
+    CastExpr(SrcLoc loc, const Expr* src)
         : Expr(loc)
         , src_(dock(src_, src))
     {}
@@ -1474,7 +1564,7 @@ protected:
 
 class ExplicitCastExpr : public CastExpr {
 public:
-    ExplicitCastExpr(Loc loc, const Expr* src, const ASTType* ast_type)
+    ExplicitCastExpr(SrcLoc loc, const Expr* src, const ASTType* ast_type)
         : CastExpr(loc, src)
         , ast_type_(ast_type)
     {}
@@ -1494,7 +1584,7 @@ private:
 class ImplicitCastExpr : public CastExpr {
 public:
     ImplicitCastExpr(const Expr* src, const Type* type)
-        : CastExpr(src->loc(), src)
+        : CastExpr(src->src_loc(), src)
     {
         type_ = type;
     }
@@ -1513,7 +1603,7 @@ private:
 class RValueExpr : public CastExpr {
 public:
     RValueExpr(const Expr* src)
-        : CastExpr(src->loc(), src)
+        : CastExpr(src->src_loc(), src)
     {}
 
     static const RValueExpr* create(const Expr* src) {
@@ -1534,7 +1624,7 @@ private:
 
 class DefiniteArrayExpr : public Expr, public Args {
 public:
-    DefiniteArrayExpr(Loc loc, Exprs&& args)
+    DefiniteArrayExpr(SrcLoc loc, Exprs&& args)
         : Expr(loc)
         , Args(std::move(args))
     {}
@@ -1550,7 +1640,7 @@ private:
 
 class RepeatedDefiniteArrayExpr : public Expr {
 public:
-    RepeatedDefiniteArrayExpr(Loc loc, const Expr* value, uint64_t count)
+    RepeatedDefiniteArrayExpr(SrcLoc loc, const Expr* value, uint64_t count)
         : Expr(loc)
         , value_(dock(value_, value))
         , count_(count)
@@ -1573,7 +1663,7 @@ private:
 
 class IndefiniteArrayExpr : public Expr {
 public:
-    IndefiniteArrayExpr(Loc loc, const Expr* dim, const ASTType* elem_ast_type)
+    IndefiniteArrayExpr(SrcLoc loc, const Expr* dim, const ASTType* elem_ast_type)
         : Expr(loc)
         , dim_(dock(dim_, dim))
         , elem_ast_type_(elem_ast_type)
@@ -1596,7 +1686,7 @@ private:
 
 class TupleExpr : public Expr, public Args {
 public:
-    TupleExpr(Loc loc, Exprs&& args)
+    TupleExpr(SrcLoc loc, Exprs&& args)
         : Expr(loc)
         , Args(std::move(args))
     {}
@@ -1612,7 +1702,7 @@ private:
 
 class SimdExpr : public Expr, public Args {
 public:
-    SimdExpr(Loc loc, Exprs&& args)
+    SimdExpr(SrcLoc loc, Exprs&& args)
         : Expr(loc)
         , Args(std::move(args))
     {}
@@ -1630,7 +1720,7 @@ class StructExpr : public Expr {
 public:
     class Elem : public ASTNode {
     public:
-        Elem(Loc loc, const Identifier* id, const Expr* expr)
+        Elem(SrcLoc loc, const Identifier* id, const Expr* expr)
             : ASTNode(loc)
             , identifier_(id)
             , expr_(dock(expr_, expr))
@@ -1653,7 +1743,7 @@ public:
 
     typedef std::deque<std::unique_ptr<const Elem>> Elems;
 
-    StructExpr(Loc loc, const ASTTypeApp* ast_type_app, Elems&& elems)
+    StructExpr(SrcLoc loc, const ASTTypeApp* ast_type_app, Elems&& elems)
         : Expr(loc)
         , ast_type_app_(ast_type_app)
         , elems_(std::move(elems))
@@ -1678,14 +1768,14 @@ private:
 
 class TypeAppExpr : public Expr {
 public:
-    TypeAppExpr(Loc loc, const Expr* lhs, ASTTypes&& ast_type_args)
+    TypeAppExpr(SrcLoc loc, const Expr* lhs, ASTTypes&& ast_type_args)
         : Expr(loc)
         , lhs_(dock(lhs_, lhs))
         , ast_type_args_(std::move(ast_type_args))
     {}
 
     static const TypeAppExpr* create(const Expr* lhs) {
-        return interlope<TypeAppExpr>(lhs, lhs->loc(), lhs, ASTTypes());
+        return interlope<TypeAppExpr>(lhs, lhs->src_loc(), lhs, ASTTypes());
     }
 
     const Expr* lhs() const { return lhs_.get(); }
@@ -1714,7 +1804,7 @@ private:
 
 class MapExpr : public Expr, public Args {
 public:
-    MapExpr(Loc loc, const Expr* lhs, Exprs&& args)
+    MapExpr(SrcLoc loc, const Expr* lhs, Exprs&& args)
         : Expr(loc)
         , Args(std::move(args))
         , lhs_(dock(lhs_, lhs))
@@ -1741,13 +1831,13 @@ private:
 
 class BlockExpr : public Expr {
 public:
-    BlockExpr(Loc loc, Stmts&& stmts, const Expr* expr)
+    BlockExpr(SrcLoc loc, Stmts&& stmts, const Expr* expr)
         : Expr(loc)
         , stmts_(std::move(stmts))
         , expr_(dock(expr_, expr))
     {}
     /// An empty BlockExpr with no @p stmts and an @p EmptyExpr as @p expr.
-    BlockExpr(Loc loc)
+    BlockExpr(SrcLoc loc)
         : BlockExpr(loc, Stmts(), new EmptyExpr(loc))
     {}
 
@@ -1774,7 +1864,7 @@ protected:
 
 class IfExpr : public Expr {
 public:
-    IfExpr(Loc loc, const Expr* cond, const Expr* then_expr, const Expr* else_expr)
+    IfExpr(SrcLoc loc, const Expr* cond, const Expr* then_expr, const Expr* else_expr)
         : Expr(loc)
         , cond_(dock(cond_, cond))
         , then_expr_(dock(then_expr_, then_expr))
@@ -1804,7 +1894,7 @@ class MatchExpr : public Expr {
 public:
     class Arm : public ASTNode {
     public:
-        Arm(Loc loc, const Ptrn* ptrn, const Expr* expr)
+        Arm(SrcLoc loc, const Ptrn* ptrn, const Expr* expr)
             : ASTNode(loc)
             , ptrn_(ptrn)
             , expr_(dock(expr_, expr))
@@ -1821,7 +1911,7 @@ public:
 
     typedef std::deque<std::unique_ptr<const Arm>> Arms;
 
-    MatchExpr(Loc loc, const Expr* expr, Arms&& arms)
+    MatchExpr(SrcLoc loc, const Expr* expr, Arms&& arms)
         : Expr(loc)
         , expr_(dock(expr_, expr))
         , arms_(std::move(arms))
@@ -1847,7 +1937,7 @@ private:
 
 class WhileExpr : public Expr {
 public:
-    WhileExpr(Loc loc, const LocalDecl* continue_decl, const Expr* cond,
+    WhileExpr(SrcLoc loc, const LocalDecl* continue_decl, const Expr* cond,
               const Expr* body, const LocalDecl* break_decl)
         : Expr(loc)
         , continue_decl_(continue_decl)
@@ -1878,7 +1968,7 @@ private:
 
 class ForExpr : public Expr {
 public:
-    ForExpr(Loc loc, const Expr* fn_expr, const Expr* expr, const LocalDecl* break_decl)
+    ForExpr(SrcLoc loc, const Expr* fn_expr, const Expr* expr, const LocalDecl* break_decl)
         : Expr(loc)
         , fn_expr_(dock(fn_expr_, fn_expr))
         , expr_(dock(expr_, expr))
@@ -1911,7 +2001,7 @@ private:
 
 class Ptrn : public Typeable {
 public:
-    Ptrn(Loc loc)
+    Ptrn(SrcLoc loc)
         : Typeable(loc)
     {}
 
@@ -1931,7 +2021,7 @@ private:
 
 class TuplePtrn : public Ptrn {
 public:
-    TuplePtrn(Loc loc, Ptrns&& elems)
+    TuplePtrn(SrcLoc loc, Ptrns&& elems)
         : Ptrn(loc)
         , elems_(std::move(elems))
     {}
@@ -1956,7 +2046,7 @@ private:
 class IdPtrn : public Ptrn {
 public:
     IdPtrn(const LocalDecl* local)
-        : Ptrn(local->loc())
+        : Ptrn(local->src_loc())
         , local_(local)
     {}
 
@@ -1977,7 +2067,7 @@ private:
 
 class EnumPtrn : public Ptrn {
 public:
-    EnumPtrn(Loc loc, const Path* path, Ptrns&& args)
+    EnumPtrn(SrcLoc loc, const Path* path, Ptrns&& args)
         : Ptrn(loc)
         , path_(path)
         , args_(std::move(args))
@@ -2005,7 +2095,7 @@ private:
 class LiteralPtrn : public Ptrn {
 public:
     LiteralPtrn(const LiteralExpr* literal, bool minus)
-        : Ptrn(literal->loc())
+        : Ptrn(literal->src_loc())
         , literal_(dock(literal_, literal))
         , minus_(minus)
     {}
@@ -2031,7 +2121,7 @@ private:
 class CharPtrn : public Ptrn {
 public:
     CharPtrn(const CharExpr* chr)
-        : Ptrn(chr->loc())
+        : Ptrn(chr->src_loc())
         , chr_(dock(chr_, chr))
     {}
 
@@ -2059,7 +2149,7 @@ private:
 
 class Stmt : public ASTNode {
 public:
-    Stmt(Loc loc)
+    Stmt(SrcLoc loc)
         : ASTNode(loc)
     {}
 
@@ -2076,7 +2166,7 @@ private:
 
 class ExprStmt : public Stmt {
 public:
-    ExprStmt(Loc loc, const Expr* expr)
+    ExprStmt(SrcLoc loc, const Expr* expr)
         : Stmt(loc)
         , expr_(dock(expr_, expr))
     {}
@@ -2096,7 +2186,7 @@ private:
 
 class ItemStmt : public Stmt {
 public:
-    ItemStmt(Loc loc, const Item* item)
+    ItemStmt(SrcLoc loc, const Item* item)
         : Stmt(loc)
         , item_(item)
     {}
@@ -2116,7 +2206,7 @@ private:
 
 class LetStmt : public Stmt {
 public:
-    LetStmt(Loc loc, const Ptrn* ptrn, const Expr* init)
+    LetStmt(SrcLoc loc, const Ptrn* ptrn, const Expr* init)
         : Stmt(loc)
         , ptrn_(ptrn)
         , init_(dock(init_, init))
@@ -2141,7 +2231,7 @@ class AsmStmt : public Stmt {
 public:
     class Elem : public ASTNode {
     public:
-        Elem(Loc loc, std::string&& constraint, const Expr* expr)
+        Elem(SrcLoc loc, std::string&& constraint, const Expr* expr)
             : ASTNode(loc)
             , constraint_(std::move(constraint))
             , expr_(dock(expr_, expr))
@@ -2159,7 +2249,7 @@ public:
 
     typedef std::deque<std::unique_ptr<const Elem>> Elems;
 
-    AsmStmt(Loc loc, std::string&& asm_template, Elems&& outputs, Elems&& inputs,
+    AsmStmt(SrcLoc loc, std::string&& asm_template, Elems&& outputs, Elems&& inputs,
             Strings&& clobbers, Strings&& options)
         : Stmt(loc)
         , asm_template_(std::move(asm_template))
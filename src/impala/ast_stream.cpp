@@ -129,11 +129,11 @@ Stream& FnDecl::stream(Stream& s) const {
     s.fmt("{}fn", is_extern() ? "extern " : "");
     if (filter()) s.fmt(" @{} ", filter());
 
-    s.fmt("{}{}", export_name_ ? (export_name_ + " ") : Symbol(), symbol());
+    s.fmt("{}{}", export_name_.empty() ? std::string() : export_name_.str() + " ", symbol());
     stream_ast_type_params(s);
 
     const FnASTType* ret = nullptr;
-    if (!params().empty() && params().back()->symbol() == "return" && params().back()->ast_type()) {
+    if (!params().empty() && params().back()->symbol() == known_symbols().return_ && params().back()->ast_type()) {
         if (auto fn_type = params().back()->ast_type()->isa<FnASTType>())
             ret = fn_type;
     }
@@ -390,7 +390,7 @@ Stream& MapExpr::stream(Stream& s) const {
 }
 
 Stream& FnExpr::stream(Stream& s) const {
-    bool has_return_type = !params().empty() && params().back()->symbol() == "return";
+    bool has_return_type = !params().empty() && params().back()->symbol() == known_symbols().return_;
     s << '|';
     stream_params(s, has_return_type);
     s << "| ";
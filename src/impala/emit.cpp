@@ -1,5 +1,9 @@
 #include "impala/ast.h"
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
 #include "thorin/continuation.h"
 #include "thorin/primop.h"
 #include "thorin/type.h"
@@ -88,6 +92,22 @@ public:
         return result;
     }
 
+    /// Forgets the @p Def%s this @p node got from an earlier @p CodeGen - see @p reset_emission.
+    static void reset(const ASTNode* node) {
+        if (auto decl = node->isa<Decl>())
+            decl->def_ = nullptr;
+        if (auto expr = node->isa<Expr>())
+            expr->extra_ = nullptr;
+        const Fn* fn = node->isa<FnDecl>();
+        if (fn == nullptr)
+            fn = node->isa<FnExpr>();
+        if (fn != nullptr) {
+            fn->continuation_ = nullptr;
+            fn->ret_param_ = nullptr;
+            fn->frame_ = nullptr;
+        }
+    }
+
     const Def* load(const Def* ptr, Loc loc) {
         auto l = world.load(cur_mem, ptr, loc);
         cur_mem = world.extract(l, 0_s, loc);
@@ -116,11 +136,24 @@ public:
     const thorin::Type* convert_rec(const Type*);
     const thorin::Type*& thorin_type(const Type* type) { return impala2thorin_[type]; }
 
+    const Def* literal_pu8(char c, Debug dbg) {
+        auto& lit = pu8s_[(unsigned char) c];
+        return lit ? lit : lit = world.literal_pu8(c, dbg);
+    }
+
     World& world;
+    bool prune = true; ///< skip items which are not @p Module::is_reachable
     const Fn* cur_fn = nullptr;
     TypeMap<const thorin::Type*> impala2thorin_;
     Continuation* cur_bb = nullptr;
     const Def* cur_mem = nullptr;
+
+    /// Literal strings and arrays consisting only of literals - keyed by their contents - are built once per module.
+    std::unordered_map<std::string, const Def*> strings;
+    std::unordered_map<std::string, const Def*> literal_arrays;
+
+private:
+    const Def* pu8s_[256] = {};
 };
 
 /*
@@ -283,8 +316,30 @@ void Fn::fn_emit_body(CodeGen& cg, Loc loc) const {
  */
 
 void Module::emit(CodeGen& cg) const {
-    for (auto&& item : items()) item->emit_head(cg);
-    for (auto&& item : items()) item->emit(cg);
+    auto is_emitted = [&] (const Item* item) { return !cg.prune || is_reachable(item); };
+    std::vector<const Item*> all_items; // the library comes first - as if it had been compiled along with this module
+    for (auto module : {library(), this}) {
+        if (module != nullptr) {
+            for (auto&& item : module->items())
+                all_items.push_back(item.get());
+        }
+    }
+
+    for (auto item : all_items) {
+        if (is_emitted(item))
+            item->emit_head(cg);
+    }
+    for (auto item : all_items) {
+        if (is_emitted(item))
+            item->emit(cg);
+    }
+
+    if (cg.prune) {
+        size_t num_pruned = std::count_if(all_items.begin(), all_items.end(), [&] (const Item* item) { return !is_emitted(item); });
+        cg.world.ILOG("pruned {} of {} items unreachable from the roots - exported functions, main and all items that are not functions", num_pruned, all_items.size());
+        if (stats().counters)
+            stats().count("items pruned before emission", num_pruned);
+    }
 }
 
 static bool is_primop_or_intrinsic(const std::string& name) {
@@ -307,17 +362,17 @@ static bool is_primop_or_intrinsic(const std::string& name) {
 void FnDecl::emit_head(CodeGen& cg) const {
     assert(def_ == nullptr);
     // no code is emitted for primops
-    if (is_extern() && abi() == "\"thorin\"" &&
+    if (is_extern() && abi() == known_symbols().abi_thorin &&
         is_primop_or_intrinsic(fn_symbol().remove_quotation()))
         return;
 
     // create thorin function
     def_ = fn_emit_head(cg, loc());
-    if (is_extern() && abi() == "")
+    if (is_extern() && abi().empty())
         continuation_->make_external();
 
     // handle main function
-    if (symbol() == "main")
+    if (symbol() == known_symbols().main)
         continuation()->make_external();
 }
 
@@ -330,12 +385,12 @@ void ExternBlock::emit_head(CodeGen& cg) const {
     for (auto&& fn_decl : fn_decls()) {
         fn_decl->emit_head(cg);
         auto continuation = fn_decl->continuation();
-        if (abi() == "\"C\"")
+        if (abi() == known_symbols().abi_c)
             continuation->make_external();
-        else if (abi() == "\"device\"") {
+        else if (abi() == known_symbols().abi_device) {
             continuation->make_external();
             continuation->attributes().cc = thorin::CC::Device;
-        } else if (abi() == "\"thorin\"" && continuation) // no continuation for primops
+        } else if (abi() == known_symbols().abi_thorin && continuation) // no continuation for primops
             continuation->set_intrinsic();
     }
 }
@@ -411,15 +466,18 @@ const Def* LiteralExpr::remit(CodeGen& cg) const {
 }
 
 const Def* CharExpr::remit(CodeGen& cg) const {
-    return cg.world.literal_pu8(value(), loc());
+    return cg.literal_pu8(value(), loc());
 }
 
 const Def* StrExpr::remit(CodeGen& cg) const {
-    Array<const Def*> args(values_.size());
-    for (size_t i = 0, e = args.size(); i != e; ++i)
-        args[i] = cg.world.literal_pu8(values_[i], loc());
-
-    return cg.world.definite_array(args, loc());
+    auto& result = cg.strings[std::string(values_.data(), values_.size())];
+    if (result == nullptr) {
+        Array<const Def*> args(values_.size());
+        for (size_t i = 0, e = args.size(); i != e; ++i)
+            args[i] = cg.literal_pu8(values_[i], loc());
+        result = cg.world.definite_array(args, loc());
+    }
+    return result;
 }
 
 const Def* CastExpr::remit(CodeGen& cg) const {
@@ -599,10 +657,35 @@ const Def* PostfixExpr::remit(CodeGen& cg) const {
 }
 
 const Def* DefiniteArrayExpr::remit(CodeGen& cg) const {
-    Array<const Def*> thorin_args(num_args());
-    for (size_t i = 0, e = num_args(); i != e; ++i)
-        thorin_args[i] = arg(i)->remit(cg);
-    return cg.world.definite_array(cg.convert(type())->as<thorin::DefiniteArrayType>()->elem_type(), thorin_args, loc());
+    auto elem_type = cg.convert(type())->as<thorin::DefiniteArrayType>()->elem_type();
+
+    // key constant tables by element type and raw contents
+    std::string key(reinterpret_cast<const char*>(&elem_type), sizeof(elem_type));
+    for (auto&& arg : args()) {
+        uint64_t bits;
+        if (auto literal = arg->isa<LiteralExpr>())
+            bits = literal->get_u64();
+        else if (auto c = arg->isa<CharExpr>())
+            bits = (unsigned char) c->value();
+        else {
+            key.clear();
+            break;
+        }
+        key.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+
+    auto emit = [&] {
+        Array<const Def*> thorin_args(num_args());
+        for (size_t i = 0, e = num_args(); i != e; ++i)
+            thorin_args[i] = arg(i)->remit(cg);
+        return cg.world.definite_array(elem_type, thorin_args, loc());
+    };
+
+    if (key.empty())
+        return emit();
+
+    auto& result = cg.literal_arrays[key];
+    return result ? result : result = emit();
 }
 
 const Def* RepeatedDefiniteArrayExpr::remit(CodeGen& cg) const {
@@ -656,7 +739,7 @@ const Def* MapExpr::remit(CodeGen& cg) const {
             auto callee = type_expr->lhs()->skip_rvalue();
             if (auto path = callee->isa<PathExpr>()) {
                 if (auto fn_decl = path->value_decl()->isa<FnDecl>()) {
-                    if (fn_decl->is_extern() && fn_decl->abi() == "\"thorin\"") {
+                    if (fn_decl->is_extern() && fn_decl->abi() == known_symbols().abi_thorin) {
                         auto name = fn_decl->fn_symbol().remove_quotation();
                         auto string_type = cg.world.ptr_type(cg.world.indefinite_array_type(cg.world.type_pu8()));
                         if (name == "alignof") {
@@ -805,6 +888,141 @@ const Def* IfExpr::remit(CodeGen& cg) const {
     return nullptr; // TODO use bottom type
 }
 
+/**
+ * Lowers a @p MatchExpr to a decision tree over a pattern matrix.
+ * Each row holds the tests that an arm still has to pass; a column is the sub-value of the scrutinee that is tested.
+ * Every sub-value is tested at most once along each path of the tree; integer and enum tests become a @c match.
+ */
+class MatchCompiler {
+public:
+    struct Test {
+        const Def* value;
+        const Ptrn* ptrn; ///< @p LiteralPtrn, @p CharPtrn, or @p EnumPtrn
+    };
+
+    struct Row {
+        size_t arm;
+        std::vector<Test> tests;
+    };
+
+    MatchCompiler(CodeGen& cg, ArrayRef<Continuation*> cases)
+        : cg_(cg)
+        , cases_(cases)
+        , reached_(cases.size(), false)
+    {}
+
+    bool reached(size_t arm) const { return reached_[arm]; }
+
+    /// Adds the tests needed to match @p value against @p ptrn; tuples are flattened into their elements.
+    void add_tests(std::vector<Test>& tests, const Ptrn* ptrn, const Def* value) {
+        if (!ptrn->is_refutable())
+            return;
+        if (auto tuple = ptrn->isa<TuplePtrn>()) {
+            for (size_t i = 0, e = tuple->num_elems(); i != e; ++i)
+                add_tests(tests, tuple->elem(i), cg_.world.extract(value, i, tuple->loc()));
+        } else {
+            tests.push_back({value, ptrn});
+        }
+    }
+
+    /// Emits the tree for @p rows in the current basic block; the last row must not have any tests.
+    void compile(const std::vector<Row>& rows, const Def* mem) {
+        auto& first = rows.front();
+        if (first.tests.empty()) {
+            reached_[first.arm] = true;
+            cg_.cur_bb->jump(cases_[first.arm], {}, cases_[first.arm]->debug());
+            return;
+        }
+
+        auto value = first.tests.front().value;
+        auto head = first.tests.front().ptrn;
+        auto enum_ptrn = head->isa<EnumPtrn>();
+
+        // distinct keys tested on value in order of first occurrence
+        std::vector<const Def*> keys;
+        std::vector<Row> defaults;
+        for (auto&& row : rows) {
+            if (auto test = find(row, value)) {
+                auto k = key(test->ptrn);
+                if (std::find(keys.begin(), keys.end(), k) == keys.end())
+                    keys.push_back(k);
+            } else {
+                defaults.push_back(row);
+            }
+        }
+
+        size_t num = keys.size();
+        Array<Continuation*> targets(num);
+        for (size_t i = 0; i != num; ++i)
+            targets[i] = cg_.basicblock({"case", head->loc().anew_begin()});
+        auto otherwise = cg_.basicblock({"otherwise", head->loc().anew_begin()});
+
+        if (enum_ptrn || is_int(head->type())) {
+            auto matcher = enum_ptrn ? cg_.world.variant_index(value, head->loc()) : value;
+            cg_.cur_bb->match(matcher, otherwise, keys, targets, {"match", head->loc().anew_begin()});
+        } else {
+            // bools and floats
+            for (size_t i = 0; i != num; ++i) {
+                auto next = i == num - 1 ? otherwise : cg_.basicblock({"next", head->loc().anew_begin()});
+                cg_.cur_bb->branch(cg_.world.cmp_eq(value, keys[i], head->loc()), targets[i], next, head->loc().anew_finis());
+                cg_.enter(next, mem);
+            }
+        }
+
+        for (size_t i = 0; i != num; ++i) {
+            std::vector<Row> specialized;
+            for (auto&& row : rows) {
+                auto test = find(row, value);
+                if (test == nullptr) {
+                    specialized.push_back(row);
+                } else if (key(test->ptrn) == keys[i]) {
+                    Row next{row.arm, {}};
+                    for (auto&& other : row.tests) {
+                        if (&other != test)
+                            next.tests.push_back(other);
+                        else if (auto enum_ptrn = other.ptrn->isa<EnumPtrn>())
+                            add_payload_tests(next.tests, enum_ptrn, value);
+                    }
+                    specialized.push_back(std::move(next));
+                }
+            }
+            cg_.enter(targets[i], mem);
+            compile(specialized, mem);
+        }
+
+        cg_.enter(otherwise, mem);
+        compile(defaults, mem);
+    }
+
+private:
+    static const Test* find(const Row& row, const Def* value) {
+        for (auto&& test : row.tests) {
+            if (test.value == value)
+                return &test;
+        }
+        return nullptr;
+    }
+
+    /// The literal @p ptrn compares against or the index of its option.
+    const Def* key(const Ptrn* ptrn) {
+        if (auto enum_ptrn = ptrn->isa<EnumPtrn>())
+            return cg_.world.literal_qu64(enum_ptrn->path()->decl()->as<OptionDecl>()->index(), ptrn->loc());
+        return ptrn->emit(cg_);
+    }
+
+    void add_payload_tests(std::vector<Test>& tests, const EnumPtrn* ptrn, const Def* value) {
+        if (ptrn->num_args() == 0)
+            return;
+        auto val = cg_.world.variant_extract(value, ptrn->path()->decl()->as<OptionDecl>()->index(), ptrn->loc());
+        for (size_t i = 0, e = ptrn->num_args(); i != e; ++i)
+            add_tests(tests, ptrn->arg(i), ptrn->num_args() == 1 ? val : cg_.world.extract(val, i, ptrn->loc()));
+    }
+
+    CodeGen& cg_;
+    ArrayRef<Continuation*> cases_;
+    std::vector<bool> reached_;
+};
+
 const Def* MatchExpr::remit(CodeGen& cg) const {
     auto thorin_type = cg.convert(type());
 
@@ -861,26 +1079,31 @@ const Def* MatchExpr::remit(CodeGen& cg) const {
                 cg.cur_bb->jump(join, {cg.cur_mem, def}, loc().anew_finis());
         }
     } else {
-        // general case: if/else
+        // general case: decision tree
+        Array<Continuation*> cases(num_arms());
+        MatchCompiler compiler(cg, cases);
+        std::vector<MatchCompiler::Row> rows;
         for (size_t i = 0, e = num_arms(); i != e; ++i) {
-            auto case_true  = cg.basicblock({"case_true",  arm(i)->loc().anew_begin()});
-            auto case_false = cg.basicblock({"case_false", arm(i)->loc().anew_begin()});
-
-            arm(i)->ptrn()->emit(cg, matcher);
+            cases[i] = cg.basicblock({"case", arm(i)->loc().anew_begin()});
+            rows.push_back({i, {}});
 
             // last pattern will always be taken
-            auto cond = i == e - 1
-                ? cg.world.literal_bool(true, arm(i)->ptrn()->loc())
-                : arm(i)->ptrn()->emit_cond(cg, matcher);
+            if (!arm(i)->ptrn()->is_refutable() || i == e - 1)
+                break;
+            compiler.add_tests(rows.back().tests, arm(i)->ptrn(), matcher);
+        }
+
+        auto mem = cg.cur_mem;
+        compiler.compile(rows, mem);
 
-            cg.cur_bb->branch(cond, case_true, case_false, arm(i)->ptrn()->loc().anew_finis());
+        for (size_t i = 0, e = rows.size(); i != e; ++i) {
+            if (!compiler.reached(i))
+                continue;
 
-            auto mem = cg.cur_mem;
-            cg.enter(case_true, mem);
+            cg.enter(cases[i], mem);
+            arm(i)->ptrn()->emit(cg, matcher);
             if (auto def = arm(i)->expr()->remit(cg))
                 cg.cur_bb->jump(join, {cg.cur_mem, def}, arm(i)->loc().anew_finis());
-
-            cg.enter(case_false, mem);
         }
     }
 
@@ -1066,11 +1289,17 @@ void AsmStmt::emit(CodeGen& cg) const {
 
 //------------------------------------------------------------------------------
 
-void emit(World& world, const Module* mod) {
+void emit(World& world, const Module* mod, bool prune) {
     CodeGen cg(world);
+    cg.prune = prune || session().lazy_sema; // unreachable items have not been checked in lazy mode
     mod->emit(cg);
 }
 
+void reset_emission(const std::vector<const ASTNode*>& nodes) {
+    for (auto node : nodes)
+        CodeGen::reset(node);
+}
+
 //------------------------------------------------------------------------------
 
 }
@@ -1,40 +1,47 @@
+#include <algorithm>
 #include <fstream>
+#include <mutex>
 
 #include "impala/impala.h"
 
 #include "thorin/util/symbol.h"
 
+#include "impala/arena.h"
 #include "impala/ast.h"
+#include "impala/library_cache.h"
+#include "impala/stats.h"
 #include "impala/token.h"
 
 namespace impala {
 
-int global_num_warnings = 0;
-int global_num_errors = 0;
-bool fancy_output = false;
-
-bool& fancy() { return fancy_output; }
-int& num_warnings() { return global_num_warnings; }
-int& num_errors() { return global_num_errors; }
-
-void init() {
-    PrecTable::init();
-    Token::init();
+std::ostream*& diagnostics() {
+    static thread_local std::ostream* stream = &std::cerr;
+    return stream;
 }
 
+void init() {}
+
 void check(std::unique_ptr<TypeTable>& typetable, const Module* mod) {
-    name_analysis(mod);
-    type_inference(typetable, mod);
-    type_analysis(mod);
+    { PassTimer timer("name analysis");  name_analysis(mod); }
+    { PassTimer timer("type inference"); type_inference(typetable, mod); }
+    { PassTimer timer("type analysis");  type_analysis(mod); }
     //borrow_check(mod);
-}
 
-Prec PrecTable::infix[Token::Num];
-
-void PrecTable::init() {
-#define IMPALA_INFIX(     tok, t_str, prec) PrecTable::infix[Token::tok] = Prec::prec;
-#define IMPALA_INFIX_ASGN(tok, t_str)       PrecTable::infix[Token::tok] = Prec::Assign;
-#include "impala/tokenlist.h"
+    if (stats().counters) {
+        stats().count("types in TypeTable", typetable->types().size());
+        stats().count("types allocated", typetable->num_type_allocations());
+        stats().count("duplicate types released", typetable->num_type_duplicates());
+        stats().count("type inference iterations", typetable->num_infer_iterations());
+        stats().count("type inference node visits", typetable->num_infer_visits());
+        stats().count("Representatives allocated", typetable->num_representatives());
+        stats().count("independent type inference groups", typetable->num_infer_groups());
+        stats().count("type applications memoized", typetable->num_app_hits());
+        stats().count("type applications reduced", typetable->num_app_misses());
+        if (session().lazy_sema) {
+            auto num_skipped = std::count_if(mod->items().begin(), mod->items().end(), [&] (const auto& item) { return !mod->is_reachable(item.get()); });
+            stats().count("items skipped by lazy semantic analysis", num_skipped);
+        }
+    }
 }
 
 }
@@ -44,31 +51,55 @@ bool compile(
     const std::vector<std::string>& file_names,
     const std::vector<std::string>& file_data,
     thorin::World& world,
-    std::ostream&)
+    std::ostream& os)
 {
-    static bool initialized = false;
-    if (!initialized) {
-        impala::init();
-        initialized = true;
+    static std::once_flag initialized;
+    std::call_once(initialized, impala::init);
+
+    // each call gets its own diagnostics, counters, and stats so several JIT compilations may run concurrently
+    impala::Session session;
+    impala::SessionScope session_scope(session);
+    auto push_diagnostics = impala::push(impala::diagnostics(), &os); // diagnostics of this compilation go to os
+
+    // all files but the last one are the library which usually stays the same from call to call
+    std::unique_ptr<impala::CheckedLibrary> library;
+    if (file_names.size() > 1) {
+        library = impala::library_cache().acquire(file_names, file_data, file_names.size() - 1);
+        if (!library->ok()) { // compile it along with the last file as usual to report all errors
+            impala::library_cache().release(std::move(library));
+            library = nullptr;
+        }
     }
-    impala::num_warnings() = 0;
-    impala::num_errors()   = 0;
+
+    // unlike main, this must run the destructors of all nodes: they own vectors, strings, and maps outside of the arena
+    impala::Arena arena;
+    impala::ArenaScope arena_scope(arena);
 
     impala::Items items;
-    for (size_t n = file_names.size(), i = 0; i < n; ++i) {
-        auto file_name = file_names[i];
-        auto file_src  = file_data[i];
-        std::istringstream program_is(file_src);
-        impala::parse(items, program_is, file_name.c_str());
+    std::unique_ptr<impala::TypeTable> own_typetable;
+    if (library) {
+        library->enter();
+        impala::parse(items, file_data.back(), file_names.back().c_str());
+    } else {
+        std::vector<impala::Source> sources;
+        for (size_t i = 0, e = file_names.size(); i != e; ++i)
+            sources.push_back({file_names[i].c_str(), file_data[i]});
+        impala::parse(items, sources);
     }
 
-    auto module = std::make_unique<const impala::Module>(file_names.back().c_str(), std::move(items));
+    auto module = std::make_unique<const impala::Module>(file_names.back().c_str(), std::move(items), library ? library->module() : nullptr);
 
-    std::unique_ptr<impala::TypeTable> typetable;
+    auto& typetable = library ? library->typetable() : own_typetable;
     impala::check(typetable, module.get());
+    world.ILOG("type inference: {} iterations, {} node visits", typetable->num_infer_iterations(), typetable->num_infer_visits());
+    auto& library_cache = impala::library_cache();
+    world.ILOG("library cache: {} hits, {} misses, {} evictions so far", library_cache.num_hits(), library_cache.num_misses(), library_cache.num_evictions());
     bool result = impala::num_errors() == 0;
     if (result)
-        impala::emit(world, module.get());
+        impala::emit(world, module.get(), /*prune*/ false);
+
+    if (library)
+        library_cache.release(std::move(library));
 
     return result;
 }
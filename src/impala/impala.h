@@ -1,14 +1,18 @@
 #ifndef IMPALA_IMPALA_H
 #define IMPALA_IMPALA_H
 
+#include <array>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "thorin/world.h"
 #include "thorin/util/stream.h"
 
+#include "impala/session.h"
 #include "impala/token.h"
 #include "impala/sema/type.h"
 
@@ -19,14 +23,31 @@ class Item;
 class Module;
 typedef std::vector<std::unique_ptr<const Item>> Items;
 
-void init();
+/// An input file: its name and its contents.
+struct Source {
+    const char* filename;
+    std::string_view src;
+};
+
+void init(); ///< Does nothing anymore - all tables are built at compile time - but is kept for existing callers.
 void parse(Items&, std::istream&, const char*);
+/// Parses the contiguous source range without copying it.
+void parse(Items&, std::string_view, const char*);
+/**
+ * Parses all @p sources concurrently - each one with its own @p Parser - and appends their items in the given order.
+ * Diagnostics and node ids are the same as if the @p sources were parsed one after another.
+ */
+void parse(Items&, const std::vector<Source>& sources);
 void name_analysis(const Module*);
+/// Infers into @p typetable if it is set already - it must stem from an earlier call, e.g. for the @p Module::library.
 void type_inference(std::unique_ptr<TypeTable>& typetable, const Module*);
 void type_analysis(const Module*);
 //void borrow_check(const ModContents*);
 void check(std::unique_ptr<TypeTable>& typetable, const Module*);
-void emit(thorin::World&, const Module*);
+/// @p prune skips functions neither exported nor used - only for whole programs since the JIT may look up any function.
+void emit(thorin::World&, const Module*, bool prune = false);
+/// Forgets what @p emit recorded on @p nodes so that they may be emitted into another @p World - see @p LibraryCache.
+void reset_emission(const std::vector<const ASTNode*>& nodes);
 
 enum class Prec {
     Bottom,
@@ -42,30 +63,34 @@ enum class Prec {
 };
 
 struct PrecTable {
-    static Prec infix[Token::Num];
-    static Prec infix_l(int tag) { return infix[tag]; }
-    static Prec infix_r(int tag) { return Prec(int(infix[tag])+1); }
-
-private:
-    static void init();
-    friend void impala::init();
+    static constexpr std::array<Prec, Token::Num> infix = [] {
+        std::array<Prec, Token::Num> infix = {};
+#define IMPALA_INFIX(     tok, t_str, prec) infix[Token::tok] = Prec::prec;
+#define IMPALA_INFIX_ASGN(tok, t_str)       infix[Token::tok] = Prec::Assign;
+#include "impala/tokenlist.h"
+        return infix;
+    }();
+
+    static constexpr Prec infix_l(int tag) { return infix[tag]; }
+    static constexpr Prec infix_r(int tag) { return Prec(int(infix[tag])+1); }
 };
 
-int& num_warnings();
-int& num_errors();
-bool& fancy();
+inline std::atomic<int>& num_warnings() { return session().num_warnings; }
+inline std::atomic<int>& num_errors() { return session().num_errors; }
+inline bool& fancy() { return session().fancy; }
+std::ostream*& diagnostics(); ///< Where @p warning%s and @p error%s go on this thread; @c std::cerr unless redirected.
 
 template<class... Args>
 void warning(const Loc& loc, const char* fmt, Args... args) {
     ++num_warnings();
-    Stream s(std::cerr);
+    Stream s(*diagnostics());
     s.fmt("{}: warning: ", loc).fmt(fmt, std::forward<Args>(args)...).endl();
 }
 
 template<class... Args>
 void error(const Loc& loc, const char* fmt, Args... args) {
     ++num_errors();
-    Stream s(std::cerr);
+    Stream s(*diagnostics());
     s.fmt("{}: error: ", loc).fmt(fmt, std::forward<Args>(args)...).endl();
 }
 
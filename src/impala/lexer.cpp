@@ -1,96 +1,101 @@
 #include "impala/lexer.h"
 
-#include <cctype>
 #include <cstdio>
-#include <stdexcept>
 
 #include "impala/impala.h"
+#include "impala/scan.h"
 
 using namespace thorin;
 
 namespace impala {
 
-static inline bool sym(int c) { return std::isalpha(c) || c == '_'; }
+static inline bool sym(int c) { return is(c, Sym); }
 static inline bool dec_nonzero(int c) { return c >= '1' && c <= '9'; }
-static inline bool space(int c) { return std::isspace(c) != 0; }
+static inline bool space(int c) { return is(c, Space); }
 static inline bool bin(int c) { return '0' <= c && c <= '1'; }
 static inline bool oct(int c) { return '0' <= c && c <= '7'; }
-static inline bool dec(int c) { return std::isdigit(c) != 0; }
-static inline bool hex(int c) { return std::isxdigit(c) != 0; }
+static inline bool dec(int c) { return is(c, Dec); }
+static inline bool hex(int c) { return is(c, Hex); }
 static inline bool eE(int c) { return c == 'e' || c == 'E'; }
 static inline bool sgn(int c){ return c == '+' || c == '-'; }
 
-Lexer::Lexer(std::istream& stream, const char* filename)
-    : stream_(stream)
-    , loc_(filename, {1, 1})
-    , peek_({1, 1})
-{
-    if (!stream_)
-        throw std::runtime_error("stream is bad");
-
-    stream_.exceptions(std::istream::badbit);
+Lexer::Lexer(std::string_view src, const char* filename)
+    : begin_(src.data())
+    , cur_(src.data())
+    , end_(src.data() + src.size())
+    , file_(session().source_map.add(filename))
+    , source_file_(&session().source_map.file(file_))
+{}
+
+template<class... Args>
+void Lexer::error(SrcLoc loc, const char* fmt, Args... args) {
+    ++num_errors_;
+    impala::error(loc.loc(), fmt, args...);
 }
 
 int Lexer::next() {
-    int c = stream_.get();
-
-    loc_.finis.row = peek_.row;
-    loc_.finis.col = peek_.col;
-
-    if (c == '\n') {
-        ++peek_.row;
-        peek_.col = 1;
-    } else if (c != std::istream::traits_type::eof())
-        ++peek_.col;
-
+    int c = peek();
+    tok_finis_ = offset();
+    if (cur_ != end_) {
+        ++cur_;
+        if (c == '\n')
+            source_file_->add_line(offset());
+    }
     return c;
 }
 
+void Lexer::skip(const char* p) {
+    if (p == cur_)
+        return;
+    for (auto nl = find(cur_, p, '\n'); nl != p; nl = find(nl + 1, p, '\n'))
+        source_file_->add_line(uint32_t(nl + 1 - begin_));
+    cur_ = p;
+    tok_finis_ = offset() - 1;
+}
+
 Token Lexer::lex() {
     while (true) {
         std::string str; // the token string is concatenated here
 
-        loc_.begin.row = peek_.row;
-        loc_.begin.col = peek_.col;
-        assert(loc_.begin.row != static_cast<uint32_t>(-1));
+        tok_begin_ = offset();
 
         // end of file
         if (accept(std::istream::traits_type::eof()))
-            return {loc_, Token::Eof};
+            return {loc(), Token::Eof};
 
         // skip whitespace
-        if (accept(space)) {
-            while (accept(space)) {}
+        if (space(peek())) {
+            skip(skip_space(cur_, end_));
             continue;
         }
 
         // +, ++, +=
         if (accept('+')) {
-            if (accept('+')) return {loc_, Token::INC};
-            if (accept('=')) return {loc_, Token::ADD_ASGN};
-            return {loc_, Token::ADD};
+            if (accept('+')) return {loc(), Token::INC};
+            if (accept('=')) return {loc(), Token::ADD_ASGN};
+            return {loc(), Token::ADD};
         }
 
         // -, --, -=, ->
         if (accept('-')) {
-            if (accept('-')) return {loc_, Token::DEC};
-            if (accept('=')) return {loc_, Token::SUB_ASGN};
-            if (accept('>')) return {loc_, Token::ARROW};
-            return {loc_, Token::SUB};
+            if (accept('-')) return {loc(), Token::DEC};
+            if (accept('=')) return {loc(), Token::SUB_ASGN};
+            if (accept('>')) return {loc(), Token::ARROW};
+            return {loc(), Token::SUB};
         }
 
         // =, ==, =>
         if (accept('=')) {
-            if (accept('=')) return {loc_, Token::EQ};
-            if (accept('>')) return {loc_, Token::FAT_ARRROW};
-            return {loc_, Token::ASGN};
+            if (accept('=')) return {loc(), Token::EQ};
+            if (accept('>')) return {loc(), Token::FAT_ARRROW};
+            return {loc(), Token::ASGN};
         }
 
         // *, *=, %, %=, ^, ^=, !, !=, :, :=
 #define IMPALA_LEX_OP(op, tok1, tok2) \
         if (accept( op )) { \
-            if (accept('=')) return {loc_, Token:: tok2}; \
-            return {loc_, Token:: tok1}; \
+            if (accept('=')) return {loc(), Token:: tok2}; \
+            return {loc(), Token:: tok1}; \
         }
         IMPALA_LEX_OP('*', MUL, MUL_ASGN)
         IMPALA_LEX_OP('%', REM, REM_ASGN)
@@ -100,90 +105,95 @@ Token Lexer::lex() {
         // <, <=, <<, <<=, >, >=, >>, >>=
 #define IMPALA_LEX_REL_SHIFT(op, tok_rel, tok_rel_eq, tok_shift, tok_shift_asgn) \
         if (accept( op )) { \
-            if (accept('=')) return {loc_, Token:: tok_rel_eq}; \
+            if (accept('=')) return {loc(), Token:: tok_rel_eq}; \
             if (accept(op)) {  \
-                if (accept('=')) return {loc_, Token:: tok_shift_asgn}; \
-                return {loc_, Token:: tok_shift}; \
+                if (accept('=')) return {loc(), Token:: tok_shift_asgn}; \
+                return {loc(), Token:: tok_shift}; \
             } \
-            return {loc_, Token:: tok_rel}; \
+            return {loc(), Token:: tok_rel}; \
         }
         IMPALA_LEX_REL_SHIFT('<', LT, LE, SHL, SHL_ASGN)
         IMPALA_LEX_REL_SHIFT('>', GT, GE, SHR, SHR_ASGN)
 
         // /, /=, comments
-#define IMPALA_WITHIN_COMMENT(delim) \
+#define IMPALA_WITHIN_COMMENT(c, delim) \
         while (true) { \
+            skip(find(cur_, end_, c)); /* eat up chars in comment in bulk */ \
             if (accept(std::istream::traits_type::eof())) { \
-                error(loc_.anew_begin(), "unterminated comment"); \
-                return {loc_, Token::Eof}; \
+                error(loc().anew_begin(), "unterminated comment"); \
+                return {loc(), Token::Eof}; \
             } \
             if (delim) break; \
-            next(); /* eat up char in comment */\
         }
         if (accept('/')) {
             if (accept('='))
-                return {loc_, Token::DIV_ASGN};
+                return {loc(), Token::DIV_ASGN};
             if (accept('*')) { // arbitrary comment
-                IMPALA_WITHIN_COMMENT(accept('*') && accept('/'));
+                skip(find_comment_end(cur_, end_)); // eat up the whole comment in bulk
+                if (accept(std::istream::traits_type::eof())) {
+                    error(loc().anew_begin(), "unterminated comment");
+                    return {loc(), Token::Eof};
+                }
+                accept('*');
+                accept('/');
                 continue;
             }
             if (accept('/')) { // end of line comment
-                IMPALA_WITHIN_COMMENT(accept('\n'));
+                IMPALA_WITHIN_COMMENT('\n', accept('\n'));
                 continue;
             }
-            return {loc_, Token::DIV};
+            return {loc(), Token::DIV};
         }
 
         // &, &=, &&, |, |=, ||
 #define IMPALA_LEX_AND_OR(op, tok_bit, tok_logic, tok_asgn) \
         if (accept( op )) { \
             if (accept('=')) \
-                return {loc_, Token:: tok_asgn}; \
+                return {loc(), Token:: tok_asgn}; \
             if (accept(op)) \
-                return {loc_, Token:: tok_logic}; \
-            return {loc_, Token:: tok_bit}; \
+                return {loc(), Token:: tok_logic}; \
+            return {loc(), Token:: tok_bit}; \
         }
         IMPALA_LEX_AND_OR('&', AND, ANDAND, AND_ASGN)
         IMPALA_LEX_AND_OR('|',  OR,   OROR,  OR_ASGN)
 
         if (accept(':')) {
             if (accept(':'))
-                return {loc_, Token::DOUBLE_COLON};
-            return {loc_, Token::COLON};
+                return {loc(), Token::DOUBLE_COLON};
+            return {loc(), Token::COLON};
         }
 
         if (accept('@')) {
             if (accept('@'))
-                return {loc_, Token::RUNRUN};
+                return {loc(), Token::RUNRUN};
             if (accept('?'))
-                return {loc_, Token::RUNKNOWN};
-            return {loc_, Token::RUN};
+                return {loc(), Token::RUNKNOWN};
+            return {loc(), Token::RUN};
         }
 
         // single character tokens
-        if (accept('(')) return {loc_, Token::L_PAREN};
-        if (accept(')')) return {loc_, Token::R_PAREN};
-        if (accept(',')) return {loc_, Token::COMMA};
-        if (accept(';')) return {loc_, Token::SEMICOLON};
-        if (accept('$')) return {loc_, Token::HLT};
-        if (accept('[')) return {loc_, Token::L_BRACKET};
-        if (accept(']')) return {loc_, Token::R_BRACKET};
-        if (accept('{')) return {loc_, Token::L_BRACE};
-        if (accept('}')) return {loc_, Token::R_BRACE};
-        if (accept('~')) return {loc_, Token::TILDE};
-        if (accept('?')) return {loc_, Token::KNOWN};
+        if (accept('(')) return {loc(), Token::L_PAREN};
+        if (accept(')')) return {loc(), Token::R_PAREN};
+        if (accept(',')) return {loc(), Token::COMMA};
+        if (accept(';')) return {loc(), Token::SEMICOLON};
+        if (accept('$')) return {loc(), Token::HLT};
+        if (accept('[')) return {loc(), Token::L_BRACKET};
+        if (accept(']')) return {loc(), Token::R_BRACKET};
+        if (accept('{')) return {loc(), Token::L_BRACE};
+        if (accept('}')) return {loc(), Token::R_BRACE};
+        if (accept('~')) return {loc(), Token::TILDE};
+        if (accept('?')) return {loc(), Token::KNOWN};
 
         // '.', floats
         if (accept('.')) {
-            str += '.';
-            if (accept(str, dec)) goto l_fractional_dot_rest;
-            if (accept('.'))      return {loc_, Token::DOTDOT};
-            return {loc_, Token::DOT};
+            if (accept(dec)) goto l_fractional_dot_rest;
+            if (accept('.'))      return {loc(), Token::DOTDOT};
+            return {loc(), Token::DOT};
         }
 
         // identifiers/keywords
         if (lex_identifier(str))
-            return {loc_, str};
+            return {loc(), str};
 
         // char literal
         if (accept(str , '\'')) {
@@ -196,7 +206,7 @@ Token Lexer::lex() {
                     break;
                 }
             }
-            return {loc_, Token::LIT_char, str};
+            return {loc(), Token::LIT_char, str};
         }
 
         // string literal
@@ -210,23 +220,23 @@ Token Lexer::lex() {
                     break;
                 }
             }
-            return {loc_, Token::LIT_str, str};
+            return {loc(), Token::LIT_str, str};
         }
 
         /*
          * literals
          */
 
-        if (accept(str, dec_nonzero)) goto l_dec;
-        if (accept(str, '0')) {
+        if (accept(dec_nonzero)) goto l_dec;
+        if (accept('0')) {
 #define IMPALA_LEX_BASE_NUM(prefix, pred) \
-            if (accept(str, (prefix))) { \
-                while (accept(str, '_')) {} \
-                if (accept(str, (pred))) { \
-                    while (accept(str, (pred)) || accept(str, '_')) {} \
-                    return lex_suffix(str, false); \
+            if (accept(prefix)) { \
+                while (accept('_')) {} \
+                if (accept(pred)) { \
+                    while (accept(pred) || accept('_')) {} \
+                    return lex_suffix(false); \
                 } \
-                return literal_error(str, false); \
+                return literal_error(false); \
             }
 
             IMPALA_LEX_BASE_NUM('b', bin)
@@ -240,67 +250,66 @@ Token Lexer::lex() {
         continue;
 
 l_dec:                                      // [0-9_]*
-        while (accept(str, dec) || accept(str, '_')) {}
-        if (accept(str, '.')) {             // [0-9]
-            if (accept(str, dec)) goto l_fractional_dot_rest;
-            if (accept(str,  eE)) goto l_exp;
-            return lex_suffix(str, true);
+        while (accept(dec) || accept('_')) {}
+        if (accept('.')) {                  // [0-9]
+            if (accept(dec)) goto l_fractional_dot_rest;
+            if (accept(eE)) goto l_exp;
+            return lex_suffix(true);
         }
-        if (accept(str,  eE)) goto l_exp;
-        return lex_suffix(str, false);
+        if (accept(eE)) goto l_exp;
+        return lex_suffix(false);
 
 l_fractional_dot_rest:                      // [0-9_]*
-        while (accept(str, dec) || accept(str, '_')) {}
-        if (accept(str,  eE)) goto l_exp;
-        return lex_suffix(str, true);
+        while (accept(dec) || accept('_')) {}
+        if (accept(eE)) goto l_exp;
+        return lex_suffix(true);
 
 l_exp:                                      // [eE][+-]?[0-9_]+
-        accept(str, sgn);
-        if (accept(str, dec) || accept(str, '_')) {
-            while (accept(str, dec) || accept(str, '_')) {}
-            return lex_suffix(str, true);
+        accept(sgn);
+        if (accept(dec) || accept('_')) {
+            while (accept(dec) || accept('_')) {}
+            return lex_suffix(true);
         }
-        return literal_error(str, true);
+        return literal_error(true);
     }
 }
 
 bool Lexer::lex_identifier(std::string& str) {
-    if (accept(str, sym)) {
-        while (accept(str, sym) || accept(str, dec)) {}
+    if (sym(peek())) {
+        auto p = skip_identifier(cur_ + 1, end_);
+        str.append(cur_, p);
+        skip(p);
         return true;
     }
     return false;
 }
 
-Token Lexer::lex_suffix(std::string& str, bool floating) {
+Token Lexer::lex_suffix(bool floating) {
     TokenTag tok = floating ? Token::LIT_f64 : Token::LIT_i32;
-    std::string suffix_str;
-    if (lex_identifier(suffix_str)) {
-        Symbol suffix(suffix_str);
-        if (floating) {
-            auto lit = Token::sym2flit(suffix);
-            if (lit == Token::Error) {
-                error(loc_, "invalid suffix on floating constant '{}'", suffix);
-                return {loc_, tok, str};
-            }
-            tok = lit;
-        } else {
-            auto lit = Token::sym2lit(suffix);
-            if (lit == Token::Error) {
-                error(loc_, "invalid suffix on constant '{}'", suffix);
-                return {loc_, tok, str};
-            }
-            tok = lit;
+    if (sym(peek())) {
+        auto p = skip_identifier(cur_ + 1, end_);
+        std::string_view suffix(cur_, p - cur_);
+        skip(p);
+
+        if (suffix != suffix_cache_.str || floating != suffix_cache_.floating)
+            suffix_cache_ = {suffix, floating, floating ? Token::sym2flit(suffix) : Token::sym2lit(suffix)};
+
+        if (suffix_cache_.tag == Token::Error) {
+            if (floating)
+                error(loc(), "invalid suffix on floating constant '{}'", std::string(suffix));
+            else
+                error(loc(), "invalid suffix on constant '{}'", std::string(suffix));
+            return {loc(), tok, text()};
         }
-        str += suffix.c_str();
+        tok = suffix_cache_.tag;
     }
 
-    return {loc_, tok, str};
+    return {loc(), tok, text()};
 }
 
-Token Lexer::literal_error(std::string& str, bool floating) {
-    error(loc_, "invalid constant '{}'", str);
-    return lex_suffix(str, floating);
+Token Lexer::literal_error(bool floating) {
+    error(loc(), "invalid constant '{}'", std::string(text()));
+    return lex_suffix(floating);
 }
 
 }
@@ -2,6 +2,7 @@
 #define IMPALA_LEXER_H
 
 #include <istream>
+#include <string_view>
 
 #include "thorin/debug.h"
 
@@ -11,17 +12,26 @@ namespace impala {
 
 class Lexer {
 public:
-    Lexer(std::istream& stream, const char* filename);
+    /// Lexes the contiguous range @p src which must outlive this @p Lexer.
+    Lexer(std::string_view src, const char* filename);
 
     Token lex(); ///< Get next \p Token in stream.
+    size_t num_errors() const { return num_errors_; } ///< Number of errors reported so far.
+    uint32_t file() const { return file_; } ///< Index of the lexed file in the @p SourceMap of the @p Session.
 
 private:
+    template<class... Args>
+    void error(SrcLoc loc, const char* fmt, Args... args);
     bool lex_identifier(std::string&);
-    Token lex_suffix(std::string&, bool floating);
-    Token literal_error(std::string&, bool floating);
+    Token lex_suffix(bool floating);
+    Token literal_error(bool floating);
     int next();
-    int peek() const { return stream_.peek(); }
-    Loc curr() const { return loc_.anew_finis(); }
+    void skip(const char* p); ///< Consumes all characters up to @p p in bulk - like repeated calls to @p next.
+    int peek() const { return cur_ != end_ ? int((unsigned char) *cur_) : std::istream::traits_type::eof(); }
+    uint32_t offset() const { return uint32_t(cur_ - begin_); }
+    SrcLoc loc() const { return {file_, tok_begin_, tok_finis_}; }
+    SrcLoc curr() const { return loc().anew_finis(); }
+    std::string_view text() const { return {begin_ + tok_begin_, size_t(offset() - tok_begin_)}; } ///< of the current token so far
 
     template<class Pred>
     bool accept(std::string& str, Pred pred) {
@@ -46,9 +56,21 @@ private:
     bool accept(char c) { return accept((int) c); }
     bool accept(std::string& str, char c) { return accept(str, (int) c); }
 
-    std::istream& stream_;
-    Loc loc_;
-    Pos peek_;
+    const char* begin_;
+    const char* cur_;
+    const char* end_;
+    uint32_t file_;
+    SourceFile* source_file_;
+    uint32_t tok_begin_ = 0; ///< offset of the first character of the current token
+    uint32_t tok_finis_ = 0; ///< offset of the last character consumed so far
+    size_t num_errors_ = 0;
+
+    /// The most recent literal suffix and its classification - generated code tends to use the same one over and over.
+    struct {
+        std::string_view str;
+        bool floating = false;
+        TokenTag tag = Token::Error;
+    } suffix_cache_;
 };
 
 }
@@ -0,0 +1,130 @@
+#include "impala/library_cache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+#include "impala/ast.h"
+
+namespace impala {
+
+CheckedLibrary::CheckedLibrary(const std::vector<std::string>& file_names, const std::vector<std::string>& file_data, size_t num)
+    : file_names_(file_names.begin(), file_names.begin() + num)
+    , file_data_(file_data.begin(), file_data.begin() + num)
+{
+    Session session;
+    SessionScope session_scope(session);
+    std::ostringstream os;
+    THORIN_PUSH(diagnostics(), &os);
+    ArenaScope arena_scope(arena_);
+    THORIN_PUSH(ASTNode::numbered(), &nodes_);
+
+    std::vector<Source> sources;
+    for (size_t i = 0; i != num; ++i)
+        sources.push_back({file_names_[i].c_str(), file_data_[i]});
+
+    Items items;
+    parse(items, sources);
+    module_ = std::make_unique<const Module>(file_names_.back().c_str(), std::move(items));
+    check(typetable_, module_.get());
+
+    checkpoint_ = typetable_->checkpoint();
+    for (size_t i = 0, e = session.source_map.size(); i != e; ++i) {
+        auto& source_file = session.source_map.file(i);
+        source_files_.emplace_back(source_file.name(), source_file.line_starts());
+    }
+    diagnostics_ = os.str();
+    num_warnings_ = session.num_warnings;
+    ok_ = session.num_errors == 0;
+    ast_gid_counter_ = session.ast_gid_counter;
+    for (auto node : nodes_) {
+        if (auto typeable = node->isa<Typeable>())
+            types_.emplace_back(typeable, typeable->type_);
+    }
+    nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(), [] (const ASTNode* node) {
+        return !node->isa<Decl>() && !node->isa<Expr>();
+    }), nodes_.end());
+}
+
+CheckedLibrary::~CheckedLibrary() {}
+
+bool CheckedLibrary::matches(const std::vector<std::string>& file_names, const std::vector<std::string>& file_data, size_t num) const {
+    return num == file_names_.size()
+        && std::equal(file_names_.begin(), file_names_.end(), file_names.begin())
+        && std::equal(file_data_.begin(), file_data_.end(), file_data.begin());
+}
+
+void CheckedLibrary::enter() const {
+    auto& session = impala::session();
+    assert(session.source_map.size() == 0 && "the files of the library must come first");
+    for (auto&& source_file : source_files_)
+        session.source_map.add(source_file.first, source_file.second);
+    session.ast_gid_counter = ast_gid_counter_;
+    session.num_warnings += num_warnings_;
+    *diagnostics() << diagnostics_;
+}
+
+void CheckedLibrary::reset() {
+    if (!ok_) // nobody compiled against it
+        return;
+    for (auto&& [typeable, type] : types_)
+        typeable->type_ = type;
+    typetable_->rollback(checkpoint_);
+    reset_emission(nodes_);
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<CheckedLibrary> LibraryCache::acquire(const std::vector<std::string>& file_names, const std::vector<std::string>& file_data, size_t num) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto i = unused_.begin(), e = unused_.end(); i != e; ++i) {
+            if ((*i)->matches(file_names, file_data, num)) {
+                auto library = std::move(*i);
+                unused_.erase(i);
+                ++hits_;
+                return library;
+            }
+        }
+    }
+
+    ++misses_;
+    return std::make_unique<CheckedLibrary>(file_names, file_data, num);
+}
+
+void LibraryCache::release(std::unique_ptr<CheckedLibrary> library) {
+    library->reset();
+    std::list<std::unique_ptr<CheckedLibrary>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unused_.push_front(std::move(library));
+        evicted = evict();
+    }
+}
+
+void LibraryCache::set_capacity(size_t capacity) {
+    std::list<std::unique_ptr<CheckedLibrary>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        evicted = evict();
+    }
+}
+
+std::list<std::unique_ptr<CheckedLibrary>> LibraryCache::evict() {
+    std::list<std::unique_ptr<CheckedLibrary>> evicted;
+    while (unused_.size() > capacity_) {
+        evicted.splice(evicted.end(), unused_, std::prev(unused_.end()));
+        ++evictions_;
+    }
+    return evicted;
+}
+
+//------------------------------------------------------------------------------
+
+LibraryCache& library_cache() {
+    static LibraryCache library_cache;
+    return library_cache;
+}
+
+}
@@ -0,0 +1,99 @@
+#ifndef IMPALA_LIBRARY_CACHE_H
+#define IMPALA_LIBRARY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "impala/arena.h"
+#include "impala/impala.h"
+
+namespace impala {
+
+class Typeable;
+
+/**
+ * The library files of a @p compile - all files but the last one - parsed and checked on their own.
+ * Its @p module serves as @p Module::library of the last file such that only that one must be checked again.
+ * Checking and emitting a @p Module against it adds types to the @p typetable and @p Def%s to the nodes of the @p module.
+ * Hence, only one compilation at a time may use it and must @p reset it afterwards - see @p LibraryCache.
+ */
+class CheckedLibrary {
+public:
+    /// Parses and checks the first @p num files in a @p Session of their own.
+    CheckedLibrary(const std::vector<std::string>& file_names, const std::vector<std::string>& file_data, size_t num);
+    CheckedLibrary(const CheckedLibrary&) = delete;
+    CheckedLibrary& operator=(const CheckedLibrary&) = delete;
+    ~CheckedLibrary();
+
+    /// Are these the first @p num files with exactly the same names and contents?
+    bool matches(const std::vector<std::string>& file_names, const std::vector<std::string>& file_data, size_t num) const;
+    /// Are there no errors? Otherwise, the files must be compiled along with the last one to report all errors as usual.
+    bool ok() const { return ok_; }
+    const Module* module() const { return module_.get(); }
+    std::unique_ptr<TypeTable>& typetable() { return typetable_; }
+
+    /// Makes the @p SrcLoc%s of the @p module valid in the current @p Session and reports the library's warnings again.
+    void enter() const;
+    /**
+     * Forgets what a compilation against the @p module left behind: new types in the @p typetable, types that inference
+     * assigned to nodes of the @p module which were used without type so far - e.g. a @p TraitDecl - and emitted @p Def%s.
+     */
+    void reset();
+
+private:
+    std::vector<std::string> file_names_;
+    std::vector<std::string> file_data_;
+    Arena arena_; // must outlive the module
+    std::unique_ptr<const Module> module_;
+    std::unique_ptr<TypeTable> typetable_;
+    TypeTable::Checkpoint checkpoint_;
+    std::vector<std::pair<std::string, std::vector<uint32_t>>> source_files_; ///< the @p SourceMap the library was parsed with
+    std::string diagnostics_;
+    int num_warnings_ = 0;
+    bool ok_ = false;
+    size_t ast_gid_counter_ = 1;
+    std::vector<std::pair<const Typeable*, const Type*>> types_; ///< the types of all nodes right after checking
+    std::vector<const ASTNode*> nodes_; ///< all @p Decl%s and @p Expr%s - the nodes @p emit records @p Def%s on
+};
+
+/**
+ * Keeps the @p CheckedLibrary%s of earlier @p compile%s - e.g. the runtime's library files the JIT passes along with each kernel.
+ * A @p CheckedLibrary is only used by one compilation at a time; concurrent ones get another one with the same files.
+ * Once more than @p capacity of them are not in use, the least recently used ones are evicted.
+ * Thread-safe.
+ */
+class LibraryCache {
+public:
+    /// A @p CheckedLibrary of the first @p num files which nobody else uses - a cached one if there is one.
+    std::unique_ptr<CheckedLibrary> acquire(const std::vector<std::string>& file_names, const std::vector<std::string>& file_data, size_t num);
+    /// @p CheckedLibrary::reset%s @p library and keeps it for later @p acquire%s.
+    void release(std::unique_ptr<CheckedLibrary> library);
+
+    size_t capacity() const { return capacity_; } ///< Maximal number of unused @p CheckedLibrary%s kept.
+    void set_capacity(size_t capacity);
+    size_t num_hits() const { return hits_; }
+    size_t num_misses() const { return misses_; }
+    size_t num_evictions() const { return evictions_; }
+
+private:
+    /// Removes the least recently used entries beyond @p capacity; needs the @p mutex_ and returns them to be destroyed without it.
+    std::list<std::unique_ptr<CheckedLibrary>> evict();
+
+    std::mutex mutex_;
+    std::list<std::unique_ptr<CheckedLibrary>> unused_; ///< most recently released first
+    std::atomic<size_t> capacity_{4};
+    std::atomic<size_t> hits_{0}, misses_{0}, evictions_{0};
+};
+
+/// The @p LibraryCache of this process - it outlives each @p Session.
+LibraryCache& library_cache();
+
+}
+
+#endif
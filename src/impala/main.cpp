@@ -1,7 +1,12 @@
+#include <algorithm>
 #include <fstream>
 #include <vector>
 #include <cctype>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
 #include "thorin/be/codegen.h"
 #include "thorin/be/c/c.h"
@@ -9,11 +14,15 @@
 #include "thorin/be/llvm/cpu.h"
 #endif
 
+#include "impala/arena.h"
 #include "impala/ast.h"
 #include "impala/args.h"
 
 #include "impala/cgen.h"
 #include "impala/impala.h"
+#include "impala/mapped_file.h"
+#include "impala/output_cache.h"
+#include "impala/stats.h"
 
 //------------------------------------------------------------------------------
 
@@ -41,11 +50,12 @@ int main(int argc, char** argv) {
         Names use_breakpoints;
         bool track_history;
 #endif
-        std::string out_name, log_name, log_level;
+        std::string out_name, log_name, log_level, cache_dir;
+        int cache_size;
         bool help,
              emit_c, emit_cint, emit_thorin, emit_ast, emit_annotated, emit_llvm,
              opt_thorin, opt_s, opt_0, opt_1, opt_2, opt_3, debug,
-             nocleanup, fancy;
+             nocleanup, noprune, lazy_sema, pipeline_lexer, parallel_infer, parallel_check, fancy, time_passes, print_stats, parallel_codegen;
 
 #ifndef NDEBUG
 #define LOG_LEVELS "{error|warn|info|verbose|debug}"
@@ -78,13 +88,29 @@ int main(int argc, char** argv) {
             .add_option<bool>            ("emit-thorin",        "", "emit textual Thorin representation of Impala program", emit_thorin, false)
             .add_option<bool>            ("f",                  "", "use fancy output: Impala's AST dump uses only parentheses where necessary", fancy, false)
             .add_option<bool>            ("g",                  "", "emit debug information", debug, false)
-            .add_option<bool>            ("nocleanup",          "", "no clean-up phase", nocleanup, false);
+            .add_option<std::string>     ("cache-dir",          "<dir>", "reuse the outputs of earlier runs with the same inputs and options from <dir>", cache_dir, "")
+            .add_option<int>             ("cache-size",         "<MiB>", "evict the least recently used outputs once the cache exceeds this size (default: 1024)", cache_size, 1024)
+            .add_option<bool>            ("lazy-sema",          "", "only analyze functions reachable from exported functions and statics; errors in all other functions are NOT reported (implies pruning)", lazy_sema, false)
+            .add_option<bool>            ("nocleanup",          "", "no clean-up phase", nocleanup, false)
+            .add_option<bool>            ("noprune",            "", "emit all functions, even those unreachable from exported functions and statics", noprune, false)
+            .add_option<bool>            ("pipeline-lexer",     "", "lex on a separate thread while parsing; pays off for huge input files", pipeline_lexer, false)
+            .add_option<bool>            ("parallel-infer",     "", "infer the bodies of functions which share no unknown types on several threads", parallel_infer, false)
+            .add_option<bool>            ("parallel-check",     "", "check the items of a module on several threads after type inference", parallel_check, false)
+            .add_option<bool>            ("parallel-codegen",   "", "run the code generators of all requested outputs concurrently", parallel_codegen, false)
+            .add_option<bool>            ("stats",              "", "print statistics about the compilation to stderr", print_stats, false)
+            .add_option<bool>            ("time-passes",        "", "print wall time, CPU time and peak-RSS growth of each phase to stderr", time_passes, false);
 
         // do cmdline parsing
         cmd_parser.parse(argc, argv);
         opt_thorin |= emit_llvm | emit_c;
 
         impala::fancy() = fancy;
+        impala::session().lazy_sema = lazy_sema;
+        impala::session().pipeline_lexer = pipeline_lexer;
+        impala::session().parallel_infer = parallel_infer;
+        impala::session().parallel_check = parallel_check;
+        impala::stats().time_passes = time_passes;
+        impala::stats().counters    = print_stats;
 
         // check optimization levels
         if (opt_s + opt_0 + opt_1 + opt_2 + opt_3 > 1)
@@ -126,6 +152,26 @@ int main(int argc, char** argv) {
             }
         }
 
+        // only runs that produce nothing but files can be replayed from the cache
+        std::unique_ptr<impala::OutputCache> cache;
+        std::vector<std::string> outputs;
+        std::mutex outputs_mutex;
+        if (!cache_dir.empty() && !emit_ast && !emit_annotated && !emit_thorin) {
+            cache = std::make_unique<impala::OutputCache>(cache_dir, uint64_t(std::max(cache_size, 0)) << 20);
+            cache->add(IMPALA_VERSION);
+            for (int i = 1; i < argc; ++i)
+                cache->add(argv[i]);
+            for (const auto& infile : infiles)
+                cache->add(impala::MappedFile(infile.c_str()).str());
+
+            if (cache->restore()) {
+                impala::stats().count("output cache hits (total)",   cache->num_hits());
+                impala::stats().count("output cache misses (total)", cache->num_misses());
+                impala::stats().dump();
+                return EXIT_SUCCESS;
+            }
+        }
+
         thorin::World world(module_name);
         impala::init();
 
@@ -172,11 +218,25 @@ int main(int argc, char** argv) {
         world.enable_history(track_history);
 #endif
 
+        // all AST nodes live in this arena which is freed in bulk after the module is gone
+        impala::Arena arena;
+        impala::ArenaScope arena_scope(arena);
+
+        // all input files form one Module which is parsed and checked anew on each run: there is no precompiled format
+        // for library files since a checked AST refers to the types of its TypeTable - only the JIT's compile() keeps them
+        // checked in memory, see LibraryCache - but -cache-dir skips whole runs whose inputs did not change
         impala::Items items;
-        for (const auto& infile : infiles) {
-            auto filename = infile.c_str();
-            std::ifstream file(filename);
-            impala::parse(items, file, filename);
+        {
+            impala::PassTimer timer("parse");
+            std::vector<std::unique_ptr<impala::MappedFile>> files;
+            std::vector<impala::Source> sources;
+            for (const auto& infile : infiles) {
+                auto filename = infile.c_str();
+                files.emplace_back(std::make_unique<impala::MappedFile>(filename));
+                sources.push_back({filename, files.back()->str()});
+            }
+
+            impala::parse(items, sources);
         }
 
         auto module = std::make_unique<const impala::Module>(infiles.front().c_str(), std::move(items));
@@ -186,8 +246,14 @@ int main(int argc, char** argv) {
 
         std::unique_ptr<impala::TypeTable> typetable;
         impala::check(typetable, module.get());
+        world.ILOG("type inference: {} iterations, {} node visits", typetable->num_infer_iterations(), typetable->num_infer_visits());
         bool result = impala::num_errors() == 0;
 
+        if (impala::stats().counters) {
+            impala::stats().count("AST arena allocations", arena.num_allocations());
+            impala::stats().count("AST arena bytes",       arena.num_bytes());
+        }
+
         if (emit_annotated)
             module->dump();
 
@@ -213,49 +279,105 @@ int main(int argc, char** argv) {
                 return EXIT_FAILURE;
             }
             impala::generate_c_interface(module.get(), opts, out_file);
+            outputs.push_back(module_name + ".h");
         }
 
-        if (result && (emit_c || emit_llvm || emit_thorin))
-            impala::emit(world, module.get());
+        auto count_defs = [&] (const char* when) {
+            if (impala::stats().counters) {
+                impala::stats().count(std::string("Thorin continuations ") + when, world.continuations().size());
+                impala::stats().count(std::string("Thorin primops ")       + when, world.primops().size());
+            }
+        };
+
+        if (result && (emit_c || emit_llvm || emit_thorin)) {
+            impala::PassTimer timer("emit");
+            impala::emit(world, module.get(), !noprune);
+        }
 
         if (result) {
             //thorin::verify_mem(world);
-            if (!nocleanup)
+            count_defs("before cleanup");
+            if (!nocleanup) {
+                impala::PassTimer timer("cleanup");
                 world.cleanup();
-            if (opt_thorin)
+                count_defs("after cleanup");
+            }
+            if (opt_thorin) {
+                impala::PassTimer timer("opt");
                 world.opt();
+                count_defs("after opt");
+            }
             if (emit_thorin)
                 world.dump();
             if (emit_c || emit_llvm) {
                 thorin::DeviceBackends backends(world, opt, debug);
                 auto emit_to_file = [&] (thorin::CodeGen& cg) {
+                    impala::PassTimer timer("codegen " + std::string(cg.file_ext()));
                     auto name = module_name + cg.file_ext();
                     std::ofstream file(name);
                     if (!file)
                         throw std::runtime_error("cannot write '" + name + "': " + strerror(errno));
                     else
                         cg.emit_stream(file);
+                    std::lock_guard<std::mutex> lock(outputs_mutex);
+                    outputs.push_back(name);
                 };
-                if (emit_c) {
-                    thorin::Cont2Config kernel_configs;
-                    thorin::c::CodeGen cg(world, kernel_configs, thorin::c::Lang::C99, debug);
-                    emit_to_file(cg);
-                }
+                thorin::Cont2Config kernel_configs;
+                std::vector<std::unique_ptr<thorin::CodeGen>> host_cgs;
+                if (emit_c)
+                    host_cgs.emplace_back(std::make_unique<thorin::c::CodeGen>(world, kernel_configs, thorin::c::Lang::C99, debug));
 #ifdef LLVM_SUPPORT
-                if (emit_llvm) {
-                    thorin::llvm::CPUCodeGen cg(world, opt, debug);
-                    emit_to_file(cg);
-                }
+                if (emit_llvm)
+                    host_cgs.emplace_back(std::make_unique<thorin::llvm::CPUCodeGen>(world, opt, debug));
 #endif
+                std::vector<thorin::CodeGen*> cgs;
+                for (auto& cg : host_cgs)
+                    cgs.push_back(cg.get());
                 for (auto& cg : backends.cgs) {
-                    if (cg) emit_to_file(*cg);
+                    if (cg) cgs.push_back(cg.get());
+                }
+
+                if (parallel_codegen && cgs.size() > 1) {
+                    // the code generators only read the world and each one writes its own file
+                    std::vector<std::exception_ptr> exceptions(cgs.size());
+                    std::vector<std::thread> threads;
+                    for (size_t i = 0, e = cgs.size(); i != e; ++i) {
+                        threads.emplace_back([&, i] {
+                            try {
+                                emit_to_file(*cgs[i]);
+                            } catch (...) {
+                                exceptions[i] = std::current_exception();
+                            }
+                        });
+                    }
+                    for (auto& thread : threads)
+                        thread.join();
+                    for (auto& exception : exceptions) {
+                        if (exception) std::rethrow_exception(exception);
+                    }
+                } else {
+                    for (auto cg : cgs)
+                        emit_to_file(*cg);
                 }
             }
-        } else {
-            return EXIT_FAILURE;
         }
 
-        return EXIT_SUCCESS;
+        // warnings would not be reported again on a hit
+        if (cache && result && impala::num_warnings() == 0) {
+            impala::PassTimer timer("store in output cache");
+            std::sort(outputs.begin(), outputs.end());
+            cache->store(outputs);
+        }
+        if (cache) {
+            impala::stats().count("output cache hits (total)",      cache->num_hits());
+            impala::stats().count("output cache misses (total)",    cache->num_misses());
+            impala::stats().count("output cache evictions (total)", cache->num_evictions());
+        }
+
+        impala::stats().dump();
+        // the process ends anyway: skip the destructors of all nodes - the arena still frees its blocks
+        module.release();
+        return result ? EXIT_SUCCESS : EXIT_FAILURE;
     } catch (std::exception const& e) {
         thorin::errf("{}", e.what());
         return EXIT_FAILURE;
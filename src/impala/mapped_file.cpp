@@ -0,0 +1,63 @@
+#include "impala/mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace impala {
+
+MappedFile::MappedFile(const char* filename) {
+#ifndef _WIN32
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open '" + std::string(filename) + "': " + std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size_ = st.st_size;
+        if (size_ == 0) {
+            ::close(fd);
+            return;
+        }
+
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            ::close(fd);
+            data_ = static_cast<const char*>(addr);
+            mapped_ = true;
+            return;
+        }
+    }
+    ::close(fd);
+#endif
+    read(filename); // pipes, devices, or no mmap available
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped_)
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+void MappedFile::read(const char* filename) {
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream)
+        throw std::runtime_error("cannot open '" + std::string(filename) + "': " + std::strerror(errno));
+
+    buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+}
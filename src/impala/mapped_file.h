@@ -0,0 +1,35 @@
+#ifndef IMPALA_MAPPED_FILE_H
+#define IMPALA_MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+namespace impala {
+
+/**
+ * Read-only view of the whole contents of a file.
+ * The file is memory-mapped where the platform supports it; otherwise it is read into an internal buffer.
+ */
+class MappedFile {
+public:
+    MappedFile(const char* filename);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view str() const { return {data_, size_}; }
+
+private:
+    void read(const char* filename);
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string buffer_; ///< used if the file could not be mapped
+};
+
+}
+
+#endif
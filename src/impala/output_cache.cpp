@@ -0,0 +1,229 @@
+#include "impala/output_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#include <mach-o/loader.h>
+#elif defined(__unix__)
+#include <link.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace impala {
+
+//------------------------------------------------------------------------------
+
+/*
+ * build IDs
+ */
+
+#if defined(__APPLE__)
+
+static std::string build_ids() {
+    std::string ids;
+    for (uint32_t i = 0, e = _dyld_image_count(); i != e; ++i) {
+        auto header = reinterpret_cast<const mach_header_64*>(_dyld_get_image_header(i));
+        auto cmd = reinterpret_cast<const char*>(header + 1);
+        for (uint32_t j = 0; j != header->ncmds; ++j) {
+            auto load = reinterpret_cast<const load_command*>(cmd);
+            if (load->cmd == LC_UUID)
+                ids.append(reinterpret_cast<const char*>(reinterpret_cast<const uuid_command*>(load)->uuid), 16);
+            cmd += load->cmdsize;
+        }
+    }
+    return ids;
+}
+
+#elif defined(__unix__)
+
+/// Appends the GNU build ID of the object @p info to @p data - or its file name, size, and modification time if it has none.
+static int add_build_id(dl_phdr_info* info, size_t, void* data) {
+    auto& ids = *static_cast<std::string*>(data);
+    for (int i = 0; i != info->dlpi_phnum; ++i) {
+        auto& phdr = info->dlpi_phdr[i];
+        if (phdr.p_type != PT_NOTE)
+            continue;
+
+        // offsets within the segment are aligned to 4 or 8 bytes
+        uintptr_t align = phdr.p_align == 8 ? 8 : 4, begin = info->dlpi_addr + phdr.p_vaddr, end = begin + phdr.p_memsz;
+        auto align_up = [&] (uintptr_t addr) { return begin + ((addr - begin + align - 1) & ~(align - 1)); };
+        for (auto cur = begin; end - cur >= sizeof(ElfW(Nhdr));) {
+            ElfW(Nhdr) note;
+            std::memcpy(&note, reinterpret_cast<const void*>(cur), sizeof(note));
+            auto name = cur + sizeof(note);
+            auto desc = align_up(name + note.n_namesz);
+            auto next = align_up(desc + note.n_descsz);
+            if (next > end)
+                break;
+            if (note.n_type == NT_GNU_BUILD_ID && note.n_namesz == 4 && std::memcmp(reinterpret_cast<const void*>(name), "GNU", 4) == 0) {
+                ids.append(reinterpret_cast<const char*>(desc), note.n_descsz);
+                return 0;
+            }
+            cur = next;
+        }
+    }
+
+    // the main program has no name
+    std::string filename = info->dlpi_name && *info->dlpi_name ? info->dlpi_name : "/proc/self/exe";
+    ids += filename;
+    std::error_code ec;
+    auto size = fs::file_size(filename, ec);
+    auto time = fs::last_write_time(filename, ec).time_since_epoch().count();
+    ids.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    ids.append(reinterpret_cast<const char*>(&time), sizeof(time));
+    return 0;
+}
+
+static std::string build_ids() {
+    std::string ids;
+    dl_iterate_phdr(add_build_id, &ids);
+    return ids;
+}
+
+#else
+
+static std::string build_ids() { return __DATE__ " " __TIME__; } // at least catches rebuilds of libimpala
+
+#endif
+
+//------------------------------------------------------------------------------
+
+OutputCache::OutputCache(std::string dir, uint64_t max_size)
+    : dir_(std::move(dir))
+    , max_size_(max_size)
+{
+    fs::create_directories(dir_);
+    load_stats();
+    add(build_ids());
+}
+
+void OutputCache::add(std::string_view data) {
+    // the size delimits consecutive pieces of data from each other
+    auto size = uint64_t(data.size());
+    for (size_t i = 0; i != sizeof(size); ++i)
+        hash_ = (hash_ ^ ((size >> (8 * i)) & 0xff)) * 1099511628211ull;
+    for (unsigned char c : data)
+        hash_ = (hash_ ^ c) * 1099511628211ull;
+    key_data_.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    key_data_ += data;
+}
+
+/// Does the file @p filename hold the key of this run?
+bool OutputCache::same_key(const std::string& filename) const {
+    std::error_code ec;
+    if (fs::file_size(filename, ec) != key_data_.size() || ec)
+        return false;
+    std::ifstream is(filename, std::ios::binary);
+    return std::equal(key_data_.begin(), key_data_.end(), std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+std::string OutputCache::key() const {
+    std::ostringstream os;
+    os << std::hex << hash_;
+    return os.str();
+}
+
+bool OutputCache::restore() {
+    load_stats();
+    std::ifstream manifest(entry() + "/manifest");
+    if (!manifest || !same_key(entry() + "/key")) {
+        ++misses_;
+        save_stats();
+        return false;
+    }
+
+    try {
+        size_t i = 0;
+        for (std::string output; std::getline(manifest, output); ++i)
+            fs::copy_file(entry() + '/' + std::to_string(i), output, fs::copy_options::overwrite_existing);
+
+        fs::last_write_time(entry(), fs::file_time_type::clock::now()); // mark as recently used
+    } catch (const fs::filesystem_error&) {
+        // evicted by a concurrent run
+        ++misses_;
+        save_stats();
+        return false;
+    }
+    ++hits_;
+    save_stats();
+    return true;
+}
+
+void OutputCache::store(const std::vector<std::string>& outputs) {
+    // fill a private directory first and rename it so that concurrent runs never see a partial entry
+    auto tmp = entry() + ".tmp" + std::to_string(std::random_device()());
+    fs::create_directories(tmp);
+    std::ofstream(tmp + "/key", std::ios::binary) << key_data_;
+    std::ofstream manifest(tmp + "/manifest");
+    for (size_t i = 0, e = outputs.size(); i != e; ++i) {
+        fs::copy_file(outputs[i], tmp + '/' + std::to_string(i), fs::copy_options::overwrite_existing);
+        manifest << outputs[i] << std::endl;
+    }
+    manifest.close();
+
+    std::error_code ec;
+    fs::rename(tmp, entry(), ec);
+    if (ec)
+        fs::remove_all(tmp, ec); // another run has stored an entry with the same hash in the meantime
+
+    load_stats();
+    evict();
+    save_stats();
+}
+
+void OutputCache::evict() {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    for (auto&& dir : fs::directory_iterator(dir_)) {
+        if (!dir.is_directory() || dir.path().filename().string().find(".tmp") != std::string::npos)
+            continue;
+
+        uint64_t size = 0;
+        for (auto&& file : fs::directory_iterator(dir.path()))
+            size += file.file_size();
+        entries.push_back({dir.path(), fs::last_write_time(dir.path()), size});
+        total += size;
+    }
+
+    std::sort(entries.begin(), entries.end(), [] (const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (auto&& entry : entries) {
+        if (total <= max_size_)
+            break;
+        std::error_code ec;
+        fs::remove_all(entry.path, ec);
+        total -= entry.size;
+        ++evictions_;
+    }
+    size_ = total;
+}
+
+void OutputCache::load_stats() {
+    std::ifstream stats(dir_ + "/stats");
+    uint64_t hits = 0, misses = 0, evictions = 0;
+    if (!(stats >> hits >> misses >> evictions))
+        hits = misses = evictions = 0;
+    hits_ = hits;
+    misses_ = misses;
+    evictions_ = evictions;
+}
+
+void OutputCache::save_stats() const {
+    std::ofstream stats(dir_ + "/stats");
+    stats << hits_.load() << ' ' << misses_.load() << ' ' << evictions_.load() << std::endl;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef IMPALA_OUTPUT_CACHE_H
+#define IMPALA_OUTPUT_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace impala {
+
+/**
+ * Keeps the files produced by earlier compiler runs, keyed by everything a run depends on (see @p add).
+ * The key always includes the build IDs of all binaries loaded into this process - the compiler, thorin, LLVM - so that
+ * rebuilding any of them invalidates the cache.
+ * Each entry is a subdirectory of the cache directory, named after a hash of the key; it also keeps the whole key to
+ * tell apart runs whose keys collide.
+ * Once the cache grows beyond its size limit, the least recently used entries are evicted.
+ * The statistics are kept in the cache directory as well and accumulate across runs.
+ */
+class OutputCache {
+public:
+    OutputCache(std::string dir, uint64_t max_size);
+
+    /// Mixes @p data into the key of this run.
+    void add(std::string_view data);
+    std::string key() const; ///< Hash of the key.
+
+    /// Copies the outputs of an earlier run with the same key to where they were written back then; returns whether there was such a run.
+    bool restore();
+    /// Saves the files @p outputs of this run under its key.
+    void store(const std::vector<std::string>& outputs);
+
+    uint64_t num_hits() const { return hits_; }
+    uint64_t num_misses() const { return misses_; }
+    uint64_t num_evictions() const { return evictions_; }
+    uint64_t size() const { return size_; } ///< Bytes in the cache after the last @p store.
+
+private:
+    std::string entry() const { return dir_ + '/' + key(); }
+    bool same_key(const std::string& filename) const;
+    void evict();
+    void load_stats();
+    void save_stats() const;
+
+    std::string dir_;
+    uint64_t max_size_;
+    std::string key_data_; ///< everything @p add%ed so far
+    uint64_t hash_ = 14695981039346656037ull; ///< FNV-1a
+    std::atomic<uint64_t> hits_{0}, misses_{0}, evictions_{0}, size_{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "impala/parallel.h"
+
+namespace impala {
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_.notify_all();
+    for (auto&& thread : threads_)
+        thread.join();
+}
+
+void ThreadPool::run(Job& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads_.empty()) {
+            for (size_t i = 1, e = num_threads(); i < e; ++i)
+                threads_.emplace_back([this] { help(); });
+        }
+        jobs_.push_back(&job);
+    }
+    work_.notify_all();
+
+    job.work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto i = std::find(jobs_.begin(), jobs_.end(), &job);
+    if (i != jobs_.end())
+        jobs_.erase(i);
+    done_.wait(lock, [&] { return job.num_helpers == 0; });
+}
+
+void ThreadPool::help() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+        if (stop_)
+            return;
+
+        auto job = jobs_.front();
+        ++job->num_helpers;
+        lock.unlock();
+        {
+            SessionScope session_scope(job->session);
+            job->work();
+        }
+        lock.lock();
+
+        // all indices of job are taken by now
+        auto i = std::find(jobs_.begin(), jobs_.end(), job);
+        if (i != jobs_.end())
+            jobs_.erase(i);
+        if (--job->num_helpers == 0)
+            done_.notify_all();
+    }
+}
+
+ThreadPool& thread_pool() {
+    static ThreadPool thread_pool;
+    return thread_pool;
+}
+
+}
@@ -0,0 +1,89 @@
+#ifndef IMPALA_PARALLEL_H
+#define IMPALA_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "impala/session.h"
+
+namespace impala {
+
+/// Number of threads @p parallel_for uses at most.
+inline size_t num_threads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+/**
+ * @p num_threads - 1 threads which help the callers of @p parallel_for; started on first use and shared by all @p Session%s.
+ * Callers never wait for a helper to become free - they work on their own @p Job until it is done - so @p parallel_for
+ * may be called from several threads at once and from within a @p Job.
+ * Thread-safe.
+ */
+class ThreadPool {
+public:
+    /// A @p parallel_for in progress.
+    struct Job {
+        Job(size_t num, std::function<void(size_t)> body)
+            : num(num)
+            , body(std::move(body))
+            , session(impala::session())
+        {}
+
+        /// Calls @p body with the indices nobody has taken yet.
+        void work() {
+            for (size_t i; (i = next++) < num;)
+                body(i);
+        }
+
+        size_t num;
+        std::function<void(size_t)> body;
+        Session& session;
+        std::atomic<size_t> next{0};
+        size_t num_helpers = 0; ///< guarded by the pool's mutex
+    };
+
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    /// Works on @p job with as many helpers as are free and returns once all of its indices are done.
+    void run(Job& job);
+
+private:
+    void help();
+
+    std::mutex mutex_;
+    std::condition_variable work_, done_;
+    std::deque<Job*> jobs_; ///< the @p Job%s which still have indices left, oldest first
+    std::vector<std::thread> threads_;
+    bool stop_ = false;
+};
+
+/// The @p ThreadPool of this process - it outlives each @p Session.
+ThreadPool& thread_pool();
+
+/**
+ * Calls @p body with each index in [0, @p num) on up to @p num_threads threads - the calling one included.
+ * All threads use the @p Session of the calling thread; @p body must not throw.
+ */
+template<class F>
+void parallel_for(size_t num, F body) {
+    if (num <= 1 || num_threads() <= 1) {
+        for (size_t i = 0; i != num; ++i)
+            body(i);
+        return;
+    }
+
+    ThreadPool::Job job(num, std::ref(body));
+    thread_pool().run(job);
+}
+
+}
+
+#endif
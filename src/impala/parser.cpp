@@ -1,12 +1,22 @@
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 
 #include "thorin/util/array.h"
 
+#include "impala/arena.h"
 #include "impala/ast.h"
 #include "impala/impala.h"
 #include "impala/lexer.h"
+#include "impala/parallel.h"
+#include "impala/ring_buffer.h"
+#include "impala/stats.h"
 
 #define VISIBILITY \
          Token::PRIV: \
@@ -107,17 +117,34 @@ class Parser;
 
 class Parser {
 public:
-    Parser(std::istream& stream, const char* filename)
-        : lexer_(stream, filename)
+    /// The @p Lexer runs on its own thread if @p Session::pipeline_lexer is set.
+    Parser(std::string_view src, const char* filename)
+        : lexer_(src, filename)
     {
-        lookahead_[0] = lexer_.lex();
-        lookahead_[1] = lexer_.lex();
-        lookahead_[2] = lexer_.lex();
-        prev_loc_ = Loc(filename, {1, 1});
+        if (session().pipeline_lexer)
+            start_lexer_thread();
+        lookahead_[0] = next_token();
+        lookahead_[1] = next_token();
+        lookahead_[2] = next_token();
+        num_tokens_ = 3;
+        prev_loc_ = SrcLoc(lexer_.file(), 0, 0);
     }
 
+    ~Parser() { stop_lexer_thread(); }
+
+    /// Waits for the lexer thread - if any - and rethrows what it threw; must be called before asking the @p Lexer.
+    void join_lexer_thread();
+    /**
+     * Makes the lexer thread - if any - give up and waits for it.
+     * Use this instead of @p join_lexer_thread if the rest of the input is not parsed anymore:
+     * The lexer thread might wait forever for the parser to make room in the pipe otherwise.
+     */
+    void stop_lexer_thread();
+
+    size_t num_tokens() const { return num_tokens_; }
+
     const Token& lookahead(size_t i = 0) const { assert(i < 3); return lookahead_[i]; }
-    Loc prev_loc() const { return prev_loc_; }
+    SrcLoc prev_loc() const { return prev_loc_; }
 
 #ifdef NDEBUG
     Token eat(TokenTag) { return lex(); }
@@ -132,19 +159,19 @@ public:
 
     class Tracker {
     public:
-        Tracker(Parser& parser, const Loc& loc)
+        Tracker(Parser& parser, SrcLoc loc)
             : parser_(parser), loc_(loc)
         {}
 
-        operator Loc() const { return {loc_.file, loc_.begin, parser_.prev_loc().finis}; }
+        operator SrcLoc() const { return {loc_.file, loc_.begin, parser_.prev_loc().finis}; }
 
     private:
         Parser& parser_;
-        Loc loc_;
+        SrcLoc loc_;
     };
 
-    Tracker track() { return Tracker(*this, lookahead().loc().anew_begin()); }
-    Tracker track(const Loc& loc) { return Tracker(*this, loc); }
+    Tracker track() { return Tracker(*this, lookahead().src_loc().anew_begin()); }
+    Tracker track(SrcLoc loc) { return Tracker(*this, loc); }
 
     template<class T, class... Args>
     const T* create(Args&&... args) { return new T(prev_loc(), std::forward<Args>(args)...); }
@@ -269,25 +296,110 @@ public:
 private:
     /// Consume next Token in input stream, fill look-ahead buffer, return consumed Token.
     Token lex();
+    Token next_token();
 
-    const LocalDecl* create_continuation_decl(const char* name, bool set_type) {
+    const LocalDecl* create_continuation_decl(Symbol name, bool set_type) {
         auto identifier = create<Identifier>(name);
         auto ast_type = set_type ? create<FnASTType>() : nullptr;
         return create<LocalDecl>(identifier, ast_type);
     }
 
+    void start_lexer_thread();
+
+    /// A @p Token along with the diagnostics the @p Lexer emitted while lexing it.
+    struct PipedToken {
+        Token token;
+        std::string diagnostics;
+    };
+
     Lexer lexer_;        ///< invoked in order to get next token
+    std::unique_ptr<RingBuffer<PipedToken, 4096>> pipe_; ///< filled by the lexer thread
+    std::thread lexer_thread_;
+    std::atomic<bool> stop_{false};
+    std::exception_ptr lexer_exception_;
+    bool piped_eof_ = false;
+    Token eof_;
     Token lookahead_[3]; ///< SLL(3) look ahead
-    Loc prev_loc_;
+    SrcLoc prev_loc_;
+    size_t num_tokens_;  ///< number of tokens lexed so far
 };
 
 //------------------------------------------------------------------------------
 
 void parse(Items& items, std::istream& is, const char* filename) {
-    Parser parser(is, filename);
+    if (!is)
+        throw std::runtime_error("stream is bad");
+
+    std::string src(std::istreambuf_iterator<char>(is), {});
+    parse(items, src, filename);
+}
+
+//------------------------------------------------------------------------------
+
+void parse(Items& items, std::string_view src, const char* filename) {
+    std::vector<const ASTNode*> parsed;
+    THORIN_PUSH(ASTNode::parsed(), stats().counters ? &parsed : nullptr);
+
+    Parser parser(src, filename);
     parser.parse_items(items);
-    if (parser.lookahead() != Token::Eof)
+    if (parser.lookahead() != Token::Eof) {
+        // a sequential Lexer would not have seen the rest of the input either - neither its errors nor what it throws
+        parser.stop_lexer_thread();
         parser.error("module item", "module contents");
+    } else {
+        parser.join_lexer_thread();
+    }
+
+    if (stats().counters) {
+        stats().count("tokens lexed", parser.num_tokens());
+        ASTNode::count(parsed);
+    }
+}
+
+void parse(Items& items, const std::vector<Source>& sources) {
+    size_t num = sources.size();
+
+    if (num <= 1 || num_threads() <= 1) {
+        for (auto&& source : sources)
+            parse(items, source.src, source.filename);
+        return;
+    }
+
+    struct Task {
+        Arena arena; // must outlive the items
+        Items items;
+        std::vector<ASTNode*> nodes;
+        std::ostringstream diagnostics;
+        std::exception_ptr exception;
+    };
+
+    std::vector<std::unique_ptr<Task>> tasks;
+    for (size_t i = 0; i != num; ++i)
+        tasks.emplace_back(std::make_unique<Task>());
+
+    parallel_for(num, [&] (size_t i) {
+        auto& task = *tasks[i];
+        ArenaScope arena_scope(task.arena);
+        THORIN_PUSH(ASTNode::unnumbered(), &task.nodes);
+        THORIN_PUSH(diagnostics(), &task.diagnostics);
+        try {
+            parse(task.items, sources[i].src, sources[i].filename);
+        } catch (...) {
+            task.exception = std::current_exception();
+        }
+    });
+
+    // merge in order as if the files had been parsed one after another
+    for (auto&& task : tasks) {
+        *diagnostics() << task->diagnostics.str();
+        if (task->exception)
+            std::rethrow_exception(task->exception);
+
+        ASTNode::number(task->nodes);
+        Arena::current()->adopt(task->arena);
+        for (auto&& item : task->items)
+            items.emplace_back(std::move(item));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -300,11 +412,84 @@ Token Parser::lex() {
     Token result = lookahead_[0];  // remember result
     lookahead_[0] = lookahead_[1]; // copy over LA2 to LA1
     lookahead_[1] = lookahead_[2]; // copy over LA3 to LA2
-    lookahead_[2] = lexer_.lex();  // fill new LA3
-    prev_loc_ = result.loc(); // remember previous loc
+    lookahead_[2] = next_token();  // fill new LA3
+    ++num_tokens_;
+    prev_loc_ = result.src_loc(); // remember previous loc
     return result;
 }
 
+void Parser::start_lexer_thread() {
+    session().source_map.file(lexer_.file()).set_shared(true);
+    pipe_ = std::make_unique<RingBuffer<PipedToken, 4096>>();
+    lexer_thread_ = std::thread([this, outer = &session()] {
+        SessionScope session_scope(*outer);
+        std::ostringstream diagnostics;
+        THORIN_PUSH(impala::diagnostics(), &diagnostics);
+
+        PipedToken piped;
+        bool eof;
+        do {
+            if (stop_)
+                return;
+            try {
+                piped.token = lexer_.lex();
+            } catch (...) {
+                lexer_exception_ = std::current_exception();
+                piped.token = Token(SrcLoc(lexer_.file(), 0, 0), Token::Eof);
+            }
+            eof = piped.token == Token::Eof;
+            piped.diagnostics.clear();
+            if (diagnostics.tellp() != 0) {
+                piped.diagnostics = diagnostics.str();
+                diagnostics.str("");
+            }
+
+            if (!pipe_->push(std::move(piped), stop_)) // back pressure
+                return;
+        } while (!eof);
+    });
+}
+
+void Parser::join_lexer_thread() {
+    if (lexer_thread_.joinable()) {
+        lexer_thread_.join();
+        session().source_map.file(lexer_.file()).set_shared(false);
+    }
+    if (lexer_exception_)
+        std::rethrow_exception(lexer_exception_);
+}
+
+void Parser::stop_lexer_thread() {
+    stop_ = true;
+    if (pipe_)
+        pipe_->wake();
+    if (lexer_thread_.joinable()) {
+        lexer_thread_.join();
+        session().source_map.file(lexer_.file()).set_shared(false);
+    }
+}
+
+Token Parser::next_token() {
+    if (pipe_) {
+        if (piped_eof_)
+            return eof_;
+
+        PipedToken piped;
+        pipe_->pop(piped);
+
+        // same place as if the Lexer had been invoked right here
+        if (!piped.diagnostics.empty())
+            *diagnostics() << piped.diagnostics;
+        if (piped.token == Token::Eof) {
+            piped_eof_ = true;
+            eof_ = piped.token;
+        }
+        return piped.token;
+    }
+
+    return lexer_.lex();
+}
+
 bool Parser::accept(TokenTag type) {
     if (type != lookahead())
         return false;
@@ -335,7 +520,7 @@ const Identifier* Parser::try_identifier(const std::string& what) {
         name = lex();
     else {
         error("identifier", what);
-        name = Token(lookahead().loc(), "<error>");
+        name = Token(lookahead().src_loc(), "<error>");
     }
 
     return new Identifier(name);
@@ -446,7 +631,7 @@ const Param* Parser::parse_param(int /*i*/, bool lambda) {
                 type = parse_type();
                 break;
             default:
-                identifier = new Identifier(tok.loc(), "<error>");
+                identifier = new Identifier(tok.src_loc(), intern("<error>"));
                 error("identifier", "parameter");
         }
     }
@@ -461,14 +646,14 @@ const Param* Parser::parse_param(int /*i*/, bool lambda) {
     } else {
         if (type == nullptr) {
             // we assume that the identifier refers to a type
-            type = new ASTTypeApp(tok.loc(), new Path(identifier));
+            type = new ASTTypeApp(tok.src_loc(), new Path(identifier));
             identifier = nullptr;
         }
         ast_type = type;
     }
 
     if (identifier == nullptr)
-        identifier = create<Identifier>("_");
+        identifier = create<Identifier>(known_symbols().underscore);
     if (pe_expr == nullptr) {
         Path::Elems elems;
         elems.emplace_back(new Path::Elem(new Identifier(tracker, identifier->symbol())));
@@ -484,8 +669,8 @@ const Param* Parser::parse_return_param() {
     auto fn_type = parse_return_type(is_continuation, /*mandatory*/ false);
 
     if (!is_continuation) {
-        auto loc = fn_type ? fn_type->loc() : prev_loc();
-        return new Param(loc, new Identifier(loc, "return"), fn_type);
+        auto loc = fn_type ? fn_type->src_loc() : prev_loc();
+        return new Param(loc, new Identifier(loc, known_symbols().return_), fn_type);
     } else
         return nullptr;
 }
@@ -501,7 +686,7 @@ const Item* Parser::parse_item() {
     switch (lookahead()) {
         case Token::ENUM:    return parse_enum_decl(tracker, vis);
         case Token::EXTERN:  return parse_extern_block_or_fn_decl(tracker, vis);
-        case Token::FN:      return parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*extern*/ false, /*abi*/ "");
+        case Token::FN:      return parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*extern*/ false, /*abi*/ known_symbols().empty);
         case Token::IMPL:    return parse_impl(tracker, vis);
         case Token::MOD:     return parse_module_or_module_decl(tracker, vis);
         case Token::STATIC:  return parse_static_item(tracker, vis);
@@ -541,9 +726,9 @@ const OptionDecl* Parser::parse_option_decl(const size_t i) {
 const Item* Parser::parse_extern_block_or_fn_decl(Tracker tracker, Visibility vis) {
     eat(Token::EXTERN);
     if (lookahead() == Token::FN)
-        return parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*extern*/ true, /*abi*/ "");
+        return parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*extern*/ true, /*abi*/ known_symbols().empty);
 
-    Symbol abi;
+    auto abi = known_symbols().empty;
     if (lookahead() == Token::LIT_str)
         abi = lex().symbol();
 
@@ -558,7 +743,7 @@ const Item* Parser::parse_extern_block_or_fn_decl(Tracker tracker, Visibility vi
 
 const FnDecl* Parser::parse_fn_decl(BodyMode mode, Tracker tracker, Visibility vis, bool is_extern, Symbol abi) {
     eat(Token::FN);
-    auto export_name = lookahead() == Token::LIT_str ? lex().symbol() : Symbol();
+    auto export_name = lookahead() == Token::LIT_str ? lex().symbol() : known_symbols().empty;
 
     const Expr* pe_expr = parse_pe_expr("partial evaluation profile of function declaration");
     auto identifier = try_identifier("function name");
@@ -596,7 +781,7 @@ const ImplItem* Parser::parse_impl(Tracker tracker, Visibility vis) {
     expect(Token::L_BRACE, "impl");
     FnDecls methods;
     while (lookahead() == Token::FN)
-        methods.emplace_back(parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*exter*/ false, /*abi*/ ""));
+        methods.emplace_back(parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*exter*/ false, /*abi*/ known_symbols().empty));
     expect(Token::R_BRACE, "closing brace of impl");
 
     return new ImplItem(tracker, vis, std::move(ast_type_params), trait, ast_type, std::move(methods));
@@ -680,7 +865,7 @@ const TraitDecl* Parser::parse_trait_decl(Tracker tracker, Visibility vis) {
     expect(Token::L_BRACE, "trait declaration");
     FnDecls methods;
     while (lookahead() == Token::FN)
-        methods.emplace_back(parse_fn_decl(BodyMode::Optional, tracker, vis, /*exter*/ false, /*abi*/ ""));
+        methods.emplace_back(parse_fn_decl(BodyMode::Optional, tracker, vis, /*exter*/ false, /*abi*/ known_symbols().empty));
     expect(Token::R_BRACE, "closing brace of trait declaration");
 
     return new TraitDecl(tracker, vis, identifier, std::move(ast_type_params), std::move(super_traits), std::move(methods));
@@ -910,7 +1095,7 @@ const Expr* Parser::parse_infix_expr(Tracker tracker, const Expr* lhs) {
 
 const MapExpr* Parser::parse_map_expr(Tracker tracker, const Expr* lhs) {
     eat(Token::L_PAREN);
-    Exprs args;
+    Exprs::Builder args;
     parse_comma_list("arguments of a map expression", Token::R_PAREN, [&] { args.emplace_back(parse_expr()); });
     return new MapExpr(tracker, lhs, std::move(args));
 }
@@ -948,7 +1133,7 @@ const Expr* Parser::parse_primary_expr() {
             lex();
             auto expr = parse_expr();
             if (accept(Token::COMMA)) {
-                Exprs args;
+                Exprs::Builder args;
                 args.emplace_back(expr);
                 parse_comma_list("elements of a tuple expression", Token::R_PAREN, [&] { args.emplace_back(parse_expr()); });
                 return new TupleExpr(tracker, std::move(args));
@@ -972,7 +1157,7 @@ const Expr* Parser::parse_primary_expr() {
                 return new RepeatedDefiniteArrayExpr(tracker, expr, count);
             }
 
-            Exprs args;
+            Exprs::Builder args;
             args.emplace_back(expr);
             parse_comma_list("elements of an array expression", Token::R_BRACKET, [&] { args.emplace_back(parse_expr()); });
             return new DefiniteArrayExpr(tracker, std::move(args));
@@ -980,7 +1165,7 @@ const Expr* Parser::parse_primary_expr() {
         case Token::SIMD: {
             lex();;
             expect(Token::L_BRACKET, "simd expression");
-            Exprs args;
+            Exprs::Builder args;
             parse_comma_list("elements of a simd expression", Token::R_BRACKET, [&] { args.emplace_back(parse_expr()); });
             return new SimdExpr(tracker, std::move(args));
         }
@@ -1000,7 +1185,7 @@ const Expr* Parser::parse_primary_expr() {
 
                 if (accept(Token::L_PAREN)) {   // type app expression + map expression
                     auto type_app_expr = new TypeAppExpr(tracker, new PathExpr(path), std::move(ast_type_args));
-                    Exprs args;
+                    Exprs::Builder args;
                     parse_comma_list("arguments of a map expression", Token::R_PAREN, [&] { args.emplace_back(parse_expr()); });
                     return new MapExpr(tracker, type_app_expr, std::move(args));
                 }
@@ -1031,7 +1216,7 @@ const Expr* Parser::parse_primary_expr() {
         case Token::WITH:       return parse_with_expr();
         case Token::WHILE:      return parse_while_expr();
         case Token::L_BRACE:    return parse_block_expr();
-        default:                error("expression", ""); return new EmptyExpr(lex().loc());
+        default:                error("expression", ""); return new EmptyExpr(lex().src_loc());
     }
 }
 
@@ -1040,13 +1225,13 @@ const LiteralExpr* Parser::parse_literal_expr() {
     Box box;
 
     switch (lookahead()) {
-        case Token::TRUE:       return new LiteralExpr(lex().loc(), LiteralExpr::LIT_bool, Box(true));
-        case Token::FALSE:      return new LiteralExpr(lex().loc(), LiteralExpr::LIT_bool, Box(false));
+        case Token::TRUE:       return new LiteralExpr(lex().src_loc(), LiteralExpr::LIT_bool, Box(true));
+        case Token::FALSE:      return new LiteralExpr(lex().src_loc(), LiteralExpr::LIT_bool, Box(false));
 #define IMPALA_LIT(itype, atype) \
         case Token::LIT_##itype: { \
             tag = LiteralExpr::LIT_##itype; \
             Box box = lookahead().box(); \
-            return new LiteralExpr(lex().loc(), tag, box); \
+            return new LiteralExpr(lex().src_loc(), tag, box); \
         }
 #include "impala/tokenlist.h"
         default: THORIN_UNREACHABLE;
@@ -1089,7 +1274,7 @@ const CharExpr* Parser::parse_char_expr() {
     } else
         error("a character", "character constant");
 
-    return new CharExpr(lex().loc(), symbol, value);
+    return new CharExpr(lex().src_loc(), symbol, value);
 }
 
 const StrExpr* Parser::parse_str_expr() {
@@ -1117,7 +1302,7 @@ const FnExpr* Parser::parse_fn_expr(bool nested) {
 
     const Expr* pe_expr = nullptr;
     if (nested)
-        pe_expr = new LiteralExpr(lookahead().loc(), LiteralExpr::LIT_bool, Box(false));
+        pe_expr = new LiteralExpr(lookahead().src_loc(), LiteralExpr::LIT_bool, Box(false));
     else
         pe_expr = parse_pe_expr("partial evaluation profile of function expression");
 
@@ -1186,11 +1371,11 @@ const ForExpr* Parser::parse_for_expr() {
     auto tracker = track();
     eat(Token::FOR);
     auto params = param_list() ? parse_param_list(Token::IN, true) : Params();
-    params.emplace_back(create<Param>(create<Identifier>("continue"), nullptr));
+    params.emplace_back(create<Param>(create<Identifier>(known_symbols().continue_), nullptr));
     auto expr = parse_expr();
     auto pe_expr = parse_pe_expr("partial evaluation profile of for loop");
     auto body = try_block_expr("body of for loop");
-    auto break_decl = create_continuation_decl("break", /*set type during InferSema*/ false);
+    auto break_decl = create_continuation_decl(known_symbols().break_, /*set type during InferSema*/ false);
     return new ForExpr(tracker, new FnExpr(tracker, pe_expr, std::move(params), body), expr, break_decl);
 }
 
@@ -1201,21 +1386,21 @@ const ForExpr* Parser::parse_with_expr() {
     auto tracker = track();
     eat(Token::WITH);
     auto params = param_list() ? parse_param_list(Token::IN, true) : Params();
-    params.emplace_back(create<Param>(create<Identifier>("break"), nullptr));
+    params.emplace_back(create<Param>(create<Identifier>(known_symbols().break_), nullptr));
     auto expr = parse_expr();
     auto pe_expr = parse_pe_expr("partial evaluation profile of with statement");
     auto body = try_block_expr("body of with statement");
-    auto break_decl = create_continuation_decl("_", /*set type during InferSema*/ false);
+    auto break_decl = create_continuation_decl(known_symbols().underscore, /*set type during InferSema*/ false);
     return new ForExpr(tracker, new FnExpr(tracker, pe_expr, std::move(params), body), expr, break_decl);
 }
 
 const WhileExpr* Parser::parse_while_expr() {
     auto tracker = track();
     eat(Token::WHILE);
-    auto continue_decl = create_continuation_decl("continue", true);
+    auto continue_decl = create_continuation_decl(known_symbols().continue_, true);
     auto cond = parse_expr();
     auto body = try_block_expr("body of while loop");
-    auto break_decl = create_continuation_decl("break", true);
+    auto break_decl = create_continuation_decl(known_symbols().break_, true);
     return new WhileExpr(tracker, continue_decl, cond, body, break_decl);
 }
 
@@ -1279,10 +1464,10 @@ const Expr* Parser::parse_pe_expr(const char* context) {
             pe_expr = parse_expr();
             expect(Token::R_PAREN, context);
         } else {
-            pe_expr = new LiteralExpr(lookahead().loc(), LiteralExpr::LIT_bool, Box(true));
+            pe_expr = new LiteralExpr(lookahead().src_loc(), LiteralExpr::LIT_bool, Box(true));
         }
     } else
-        pe_expr = new LiteralExpr(lookahead().loc(), LiteralExpr::LIT_bool, Box(false));
+        pe_expr = new LiteralExpr(lookahead().src_loc(), LiteralExpr::LIT_bool, Box(false));
 
     return pe_expr;
 }
@@ -1311,7 +1496,7 @@ const Ptrn* Parser::parse_ptrn() {
                 return parse_enum_ptrn(path.release());
             }
             auto id = path->elem(0)->identifier();
-            return parse_id_ptrn(new Identifier(path->loc(), id->symbol()));
+            return parse_id_ptrn(new Identifier(path->src_loc(), id->symbol()));
         }
     }
 }
@@ -1319,7 +1504,7 @@ const Ptrn* Parser::parse_ptrn() {
 const TuplePtrn* Parser::parse_tuple_ptrn() {
     auto tracker = track();
     eat(Token::L_PAREN);
-    Ptrns elems;
+    Ptrns::Builder elems;
     parse_comma_list("closing parenthesis of tuple pattern", Token::R_PAREN, [&] {
         elems.emplace_back(parse_ptrn());
     });
@@ -1327,7 +1512,7 @@ const TuplePtrn* Parser::parse_tuple_ptrn() {
 }
 
 const IdPtrn* Parser::parse_id_ptrn(const Identifier* id) {
-    auto tracker = id ? track(id->loc()) : track();
+    auto tracker = id ? track(id->src_loc()) : track();
     auto mut = id ? false : accept(Token::MUT);
     auto identifier = id ? id : try_identifier("local variable in let binding");
     auto ast_type = accept(Token::COLON) ? parse_type() : nullptr;
@@ -1335,8 +1520,8 @@ const IdPtrn* Parser::parse_id_ptrn(const Identifier* id) {
 }
 
 const EnumPtrn* Parser::parse_enum_ptrn(const Path* path) {
-    auto tracker = track(path->loc());
-    Ptrns args;
+    auto tracker = track(path->src_loc());
+    Ptrns::Builder args;
     if (lookahead() == Token::L_PAREN) {
         eat(Token::L_PAREN);
         parse_comma_list("closing parenthesis of enum pattern", Token::R_PAREN, [&] {
@@ -0,0 +1,92 @@
+#ifndef IMPALA_RING_BUFFER_H
+#define IMPALA_RING_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace impala {
+
+/**
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ * @p N must be a power of two; at most @p N elements are in flight.
+ * The blocking @p push and @p pop spin for a little while and then sleep until the other side makes progress.
+ */
+template<class T, size_t N>
+class RingBuffer {
+    static_assert(N != 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    /// Called by the producer only; fails if the buffer is full.
+    bool try_push(T&& val) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == N)
+            return false;
+        slots_[tail & (N - 1)] = std::move(val);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Called by the consumer only; fails if the buffer is empty.
+    bool try_pop(T& val) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+        val = std::move(slots_[head & (N - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Called by the producer only; waits until there is room or @p stop is set and returns whether @p val was pushed.
+    bool push(T&& val, const std::atomic<bool>& stop) {
+        bool pushed = false;
+        wait([&] { return (pushed = try_push(std::move(val))) || stop; });
+        wake();
+        return pushed;
+    }
+
+    /// Called by the consumer only; waits until there is an element.
+    void pop(T& val) {
+        wait([&] { return try_pop(val); });
+        wake();
+    }
+
+    /// Wakes up the other side, e.g. after setting the @c stop flag of @p push.
+    void wake() {
+        // a read-modify-write rather than a load: either it sees a new sleeper or that sleeper sees what happened before
+        if (num_sleepers_.fetch_add(0) != 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cond_.notify_all();
+        }
+    }
+
+private:
+    template<class Ready>
+    void wait(Ready ready) {
+        for (int i = 0; i != 64; ++i) {
+            if (ready())
+                return;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        num_sleepers_.fetch_add(1);
+        cond_.wait(lock, ready);
+        num_sleepers_.fetch_sub(1);
+    }
+
+    alignas(64) std::atomic<size_t> head_{0}; ///< next slot to pop
+    alignas(64) std::atomic<size_t> tail_{0}; ///< next slot to push
+    std::array<T, N> slots_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<int> num_sleepers_{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "impala/scan.h"
+
+#if defined(__AVX2__)
+#define IMPALA_SCAN_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMPALA_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace impala {
+
+//------------------------------------------------------------------------------
+
+/*
+ * vector kernels
+ */
+
+#if defined(IMPALA_SCAN_AVX2) || defined(IMPALA_SCAN_SSE2)
+
+static inline int ctz(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return int(i);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#ifdef IMPALA_SCAN_AVX2
+typedef __m256i Vec;
+static constexpr int vec_size = 32;
+static inline Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+static inline Vec splat(char c) { return _mm256_set1_epi8(c); }
+static inline Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+static inline Vec either(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+static inline Vec both(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+static inline Vec sub(Vec a, Vec b) { return _mm256_sub_epi8(a, b); }
+static inline Vec min_u(Vec a, Vec b) { return _mm256_min_epu8(a, b); }
+static inline uint32_t mask(Vec a) { return uint32_t(_mm256_movemask_epi8(a)); }
+#else
+typedef __m128i Vec;
+static constexpr int vec_size = 16;
+static inline Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+static inline Vec splat(char c) { return _mm_set1_epi8(c); }
+static inline Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+static inline Vec either(Vec a, Vec b) { return _mm_or_si128(a, b); }
+static inline Vec both(Vec a, Vec b) { return _mm_and_si128(a, b); }
+static inline Vec sub(Vec a, Vec b) { return _mm_sub_epi8(a, b); }
+static inline Vec min_u(Vec a, Vec b) { return _mm_min_epu8(a, b); }
+static inline uint32_t mask(Vec a) { return uint32_t(_mm_movemask_epi8(a)); }
+#endif
+
+/// Lanes of @p v in [@p lo, @p hi]: <tt>v - lo <= hi - lo</tt> as unsigned bytes.
+static inline Vec in_range(Vec v, char lo, char hi) {
+    auto d = sub(v, splat(lo));
+    return eq(min_u(d, splat(char(hi - lo))), d);
+}
+
+/// Applies @p matches to whole vectors and @p scalar to the remainder; the first lane with a set bit ends the run.
+template<class Matches, class Scalar>
+static inline const char* scan(const char* p, const char* end, Matches matches, Scalar scalar) {
+    for (; end - p >= vec_size; p += vec_size) {
+        if (auto m = mask(matches(load(p))))
+            return p + ctz(m);
+    }
+    while (p != end && !scalar((unsigned char) *p))
+        ++p;
+    return p;
+}
+
+const char* skip_space(const char* p, const char* end) {
+    return scan(p, end, [] (Vec v) {
+        auto space = either(eq(v, splat(' ')), in_range(v, '\t', '\r'));
+        return eq(space, splat(0));
+    }, [] (int c) { return !is(c, Space); });
+}
+
+const char* skip_identifier(const char* p, const char* end) {
+    return scan(p, end, [] (Vec v) {
+        auto alpha = in_range(either(v, splat(0x20)), 'a', 'z'); // setting bit 5 maps 'A'-'Z' to 'a'-'z'
+        auto ident = either(either(alpha, in_range(v, '0', '9')), eq(v, splat('_')));
+        return eq(ident, splat(0));
+    }, [] (int c) { return !is(c, Sym | Dec); });
+}
+
+const char* find(const char* p, const char* end, char c) {
+    return scan(p, end, [&] (Vec v) { return eq(v, splat(c)); }, [&] (int x) { return x == (unsigned char) c; });
+}
+
+const char* find_comment_end(const char* p, const char* end) {
+    // a '*' in lane i and a '/' in lane i of the vector loaded one byte later; this needs one byte beyond the vector
+    for (; end - p > vec_size; p += vec_size) {
+        if (auto m = mask(both(eq(load(p), splat('*')), eq(load(p + 1), splat('/')))))
+            return p + ctz(m);
+    }
+    for (; end - p >= 2; ++p) {
+        if (p[0] == '*' && p[1] == '/')
+            return p;
+    }
+    return end;
+}
+
+#else
+
+//------------------------------------------------------------------------------
+
+/*
+ * scalar fallback
+ */
+
+const char* skip_space(const char* p, const char* end) {
+    while (p != end && is((unsigned char) *p, Space))
+        ++p;
+    return p;
+}
+
+const char* skip_identifier(const char* p, const char* end) {
+    while (p != end && is((unsigned char) *p, Sym | Dec))
+        ++p;
+    return p;
+}
+
+const char* find(const char* p, const char* end, char c) {
+    while (p != end && *p != c)
+        ++p;
+    return p;
+}
+
+const char* find_comment_end(const char* p, const char* end) {
+    for (; end - p >= 2; ++p) {
+        if (p[0] == '*' && p[1] == '/')
+            return p;
+    }
+    return end;
+}
+
+#endif
+
+}
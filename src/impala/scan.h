@@ -0,0 +1,47 @@
+#ifndef IMPALA_SCAN_H
+#define IMPALA_SCAN_H
+
+#include <array>
+#include <cstdint>
+
+namespace impala {
+
+/// Character classes of the @p Lexer as bits of @p char_classes.
+enum CharClass : uint8_t {
+    Space = 1 << 0, ///< <tt>' '</tt>, <tt>\\t</tt>, <tt>\\n</tt>, <tt>\\v</tt>, <tt>\\f</tt>, <tt>\\r</tt>
+    Sym   = 1 << 1, ///< <tt>[A-Za-z_]</tt>, i.e. may start an identifier
+    Dec   = 1 << 2, ///< <tt>[0-9]</tt>
+    Hex   = 1 << 3, ///< <tt>[0-9A-Fa-f]</tt>
+};
+
+/// Maps each byte to its @p CharClass%es - ASCII only like the "C" locale.
+inline constexpr std::array<uint8_t, 256> char_classes = [] {
+    std::array<uint8_t, 256> result = {};
+    for (int c : {' ', '\t', '\n', '\v', '\f', '\r'}) result[c] |= Space;
+    for (int c = 'a'; c <= 'z'; ++c) result[c] |= Sym;
+    for (int c = 'A'; c <= 'Z'; ++c) result[c] |= Sym;
+    result['_'] |= Sym;
+    for (int c = '0'; c <= '9'; ++c) result[c] |= Dec | Hex;
+    for (int c = 'a'; c <= 'f'; ++c) result[c] |= Hex;
+    for (int c = 'A'; c <= 'F'; ++c) result[c] |= Hex;
+    return result;
+}();
+
+/// Does @p c belong to one of the @p classes? @c EOF belongs to none.
+inline bool is(int c, uint8_t classes) { return c >= 0 && c < 256 && (char_classes[c] & classes) != 0; }
+
+/**
+ * @name bulk scanning
+ * Each function returns the first position in [@p p, @p end) that ends the respective run or @p end if there is none.
+ * These use SSE2 or AVX2 - whichever the compiler targets - and fall back to the @p char_classes otherwise.
+ */
+///@{
+const char* skip_space(const char* p, const char* end);       ///< Skips @p Space.
+const char* skip_identifier(const char* p, const char* end);  ///< Skips @p Sym and @p Dec.
+const char* find(const char* p, const char* end, char c);     ///< Finds @p c, e.g. the end of a <tt>//</tt> comment.
+const char* find_comment_end(const char* p, const char* end); ///< Finds the <tt>*</tt> of the first <tt>*/</tt>.
+///@}
+
+}
+
+#endif
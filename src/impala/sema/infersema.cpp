@@ -1,10 +1,15 @@
+#include <algorithm>
+#include <deque>
 #include <memory>
+#include <numeric>
 
 #include "thorin/util/array.h"
 #include "thorin/util/iterator.h"
 
+#include "impala/arena.h"
 #include "impala/ast.h"
 #include "impala/impala.h"
+#include "impala/parallel.h"
 
 using namespace thorin;
 
@@ -43,28 +48,29 @@ public:
 
     /// obeys subtyping
     const Type* coerce(const Type* dst, const Expr* src);
-    const Type* coerce(const Typeable* dst, const Expr* src) { return dst->type_ = coerce(dst->type_, src); }
+    const Type* coerce(const Typeable* dst, const Expr* src) { return update(dst->type_, coerce(dst->type_, src)); }
     void assign(const Expr* dst, const Expr* src);
 
     // infer wrappers
 
     const Type* infer(const LocalDecl* local) {
+        ++solver().num_visits;
         auto type = local->infer(*this);
         constrain(local, type);
         return type;
     }
-    const Type* infer(const Ptrn* p) { return constrain(p, p->infer(*this)); }
-    const Type* infer(const FieldDecl* f) { return constrain(f, f->infer(*this)); }
-    const Type* infer(const OptionDecl* o) { return constrain(o, o->infer(*this)); }
-    void infer(const Item* n) { n->infer(*this); }
+    const Type* infer(const Ptrn* p) { ++solver().num_visits; return constrain(p, p->infer(*this)); }
+    const Type* infer(const FieldDecl* f) { ++solver().num_visits; return constrain(f, f->infer(*this)); }
+    const Type* infer(const OptionDecl* o) { ++solver().num_visits; return constrain(o, o->infer(*this)); }
+    void infer(const Item* n) { ++solver().num_visits; n->infer(*this); }
     const Type* infer_head(const Item* n) {
-        return (n->type_ == nullptr || n->type_->isa<UnknownType>()) ? n->type_ = n->infer_head(*this) : n->type_;
+        return (n->type_ == nullptr || n->type_->isa<UnknownType>()) ? update(n->type_, n->infer_head(*this)) : n->type_;
     }
-    void infer(const Stmt* n) { n->infer(*this); }
-    const Type* infer(const Expr* expr) { return constrain(expr, expr->infer(*this)); }
-    const Type* infer(const Expr* expr, const Type* t) { return constrain(expr, expr->infer(*this), t); }
-    const Type* infer(const Path* path) { return constrain(path, path->infer(*this)); }
-    const Type* infer(const Path* path, const Type* t) { return constrain(path, path->infer(*this), t); }
+    void infer(const Stmt* n) { ++solver().num_visits; n->infer(*this); }
+    const Type* infer(const Expr* expr) { ++solver().num_visits; return constrain(expr, expr->infer(*this)); }
+    const Type* infer(const Expr* expr, const Type* t) { ++solver().num_visits; return constrain(expr, expr->infer(*this), t); }
+    const Type* infer(const Path* path) { ++solver().num_visits; return constrain(path, path->infer(*this)); }
+    const Type* infer(const Path* path, const Type* t) { ++solver().num_visits; return constrain(path, path->infer(*this), t); }
 
     const Var* infer(const ASTTypeParam* ast_type_param) {
         if (!ast_type_param->type())
@@ -73,6 +79,7 @@ public:
     }
 
     const Type* infer(const ASTType* ast_type) {
+        ++solver().num_visits;
         return constrain(ast_type, ast_type->infer(*this));
     }
 
@@ -87,7 +94,7 @@ public:
     const Type* rvalue(const Expr* expr) {
         auto type = infer(expr);
         if (type->isa<RefType>() || (type->isa<UnknownType>() && !expr->isa<RValueExpr>())) {
-            todo_ = true;
+            retry();
             return infer(RValueExpr::create(expr));
         }
         return type;
@@ -97,6 +104,16 @@ public:
         return ref ? ref_type(type, ref->is_mut(), ref->addr_space()) : type;
     }
 
+    // worklist
+
+    /**
+     * Infers all items of @p module.
+     * Afterwards, only those items which read a @p Representative that has changed in the meantime are inferred again
+     * until no item is invalidated anymore.
+     * With @p Session::parallel_infer, the bodies of @p is_independent functions are inferred on several threads.
+     */
+    void run(const Module* module);
+
 private:
     /// Used for union/find - see https://en.wikipedia.org/wiki/Disjoint-set_data_structure#Disjoint-set_forests .
     struct Representative {
@@ -111,8 +128,35 @@ private:
         Representative* parent = nullptr;
         const Type* type = nullptr;
         int rank = 0;
+        std::vector<size_t> users; ///< indices of the items which have read this @p Representative since it last changed
+        size_t first_user = size_t(-1); ///< first item which has read this @p Representative of an @p UnknownType
+    };
+
+    /// Union-find and worklist of the items one thread infers; items of different @p Solver%s must not share @p UnknownType%s.
+    struct Solver {
+        /// A @p sparse one only keeps the types it sees in a hash map - @p representatives would grow to the highest gid.
+        Solver(size_t num_items, bool sparse = false)
+            : dirty(num_items)
+            , sparse(sparse)
+        {}
+
+        std::vector<Representative*> representatives;    ///< indexed by gid; @c nullptr if not created yet
+        TypeMap<Representative*> sparse_representatives; ///< used instead of @p representatives if @p sparse
+        std::deque<Representative> pool;              ///< allocates @p Representative%s in chunks at stable addresses
+        std::vector<bool> dirty;
+        size_t cur_item = no_item;
+        size_t num_visits = 0;
+        bool sparse;
+
+        /// The @p Solver of this thread.
+        static Solver*& current() {
+            static thread_local Solver* solver = nullptr;
+            return solver;
+        }
     };
 
+    static Solver& solver() { return *Solver::current(); }
+
     Representative* representative(const Type* type);
     Representative* find(Representative* repr);
     const Type* find(const Type* type);
@@ -129,10 +173,38 @@ private:
      */
     Representative* unify_by_rank(Representative* x, Representative* y);
 
-    TypeMap<std::unique_ptr<Representative>> representatives_;
-    bool todo_ = true;
+    /// Records that the current item depends on @p repr - and on the unknown operands of its type.
+    void read(Representative* repr);
+    /// Schedules all items which have read @p repr for another round.
+    void invalidate(Representative* repr);
+    /// Items which read a common @p UnknownType end up in the same group - see @p num_infer_groups.
+    void unite_items(size_t a, size_t b) { item_groups_[item_group(a)] = item_group(b); }
+    size_t item_group(size_t i) {
+        while (item_groups_[i] != i)
+            i = item_groups_[i] = item_groups_[item_groups_[i]];
+        return i;
+    }
+    /// Schedules the current item for another round.
+    void retry() { if (solver().cur_item != no_item) solver().dirty[solver().cur_item] = true; }
+    /// Sets @p slot to @p type and invalidates the readers of the old type if it won't be found via union-find anymore.
+    const Type*& update(const Type*& slot, const Type* type);
+
+    /// Infers the items which got invalidated again until none is; returns the number of rounds including the first one.
+    size_t fixpoint(const Items& items);
+    /**
+     * Can the body of @p item be inferred on its own, i.e. concurrently to all other items?
+     * This is the case for a function which only reads types no other item can change anymore: its own type and those of
+     * the items it uses are known - including fields and options.
+     * Thus, it shares no @p UnknownType with any other item and inferring it earlier or later yields the same types.
+     */
+    bool is_independent(const Item* item);
+    bool is_settled(const Typeable* typeable) { return typeable->type_ != nullptr && find(typeable->type_)->is_known(); }
+    /// Infers all items @p items[i] with @p todo[i] on several threads - each one with its own @p Solver.
+    void infer_concurrently(const Items& items, const std::vector<bool>& todo);
+
+    static constexpr size_t no_item = size_t(-1);
 
-    friend void type_inference(std::unique_ptr<TypeTable>& typetable, const Module*);
+    std::vector<size_t> item_groups_;
 };
 
 //------------------------------------------------------------------------------
@@ -197,13 +269,16 @@ const Type* InferSema::close(int num_lambdas, const Type* body) {
 const Type* InferSema::find_type(const Type*& type) {
     if (type == nullptr)
         return type = unknown_type();
-    return type = find(type);
+    auto result = find(type);
+    if (result != type) // don't touch the type of another item which may be inferred concurrently
+        type = result;
+    return result;
 }
 
 const Type*& InferSema::constrain(const Type*& t, const Type* u) {
     if (t == nullptr)
         return t = find(u);
-    return t = unify(t, u);
+    return update(t, unify(t, u));
 }
 
 const Type* InferSema::coerce(const Type* dst, const Expr* src) {
@@ -231,6 +306,8 @@ void InferSema::assign(const Expr* dst, const Expr* src) {
 const Type* InferSema::unify(const Type* dst, const Type* src) {
     auto dst_repr = find(representative(dst));
     auto src_repr = find(representative(src));
+    read(dst_repr);
+    read(src_repr);
 
     dst = dst_repr->type;
     src = src_repr->type;
@@ -284,25 +361,32 @@ const Type* InferSema::unify(const Type* dst, const Type* src) {
  */
 
 auto InferSema::representative(const Type* type) -> Representative* {
-    auto i = representatives_.find(type);
-    if (i == representatives_.end()) {
-        auto p = representatives_.emplace(type, std::make_unique<Representative>(type));
-        assert_unused(p.second);
-        i = p.first;
+    auto& s = solver();
+    Representative** repr;
+    if (s.sparse) {
+        repr = &s.sparse_representatives.emplace(type, nullptr).first->second;
+    } else {
+        auto gid = type->gid();
+        if (gid >= s.representatives.size())
+            s.representatives.resize(gid + 1, nullptr);
+        repr = &s.representatives[gid];
     }
-    return &*i->second;
+
+    if (*repr == nullptr)
+        *repr = &s.pool.emplace_back(type);
+    return *repr;
 }
 
 auto InferSema::find(Representative* repr) -> Representative* {
-    if (repr->parent != repr) {
-        todo_ = true;
+    if (repr->parent != repr)
         repr->parent = find(repr->parent);
-    }
     return repr->parent;
 }
 
 const Type* InferSema::find(const Type* type) {
-    return find(representative(type))->type;
+    auto repr = find(representative(type));
+    read(repr);
+    return repr->type;
 }
 
 auto InferSema::unify(Representative* x, Representative* y) -> Representative* {
@@ -311,7 +395,7 @@ auto InferSema::unify(Representative* x, Representative* y) -> Representative* {
     if (x == y)
         return x;
     ++x->rank;
-    todo_ = true;
+    invalidate(y);
     return y->parent = x;
 }
 
@@ -320,29 +404,217 @@ auto InferSema::unify_by_rank(Representative* x, Representative* y) -> Represent
 
     if (x == y)
         return x;
-    if (x->rank < y->rank)
+    if (x->rank < y->rank) {
+        invalidate(x);
         return x->parent = y;
-    else if (x->rank > y->rank)
+    } else if (x->rank > y->rank) {
+        invalidate(y);
         return y->parent = x;
-    else {
+    } else {
         ++x->rank;
+        invalidate(y);
         return y->parent = x;
     }
 }
 
 //------------------------------------------------------------------------------
 
-void type_inference(std::unique_ptr<TypeTable>& typetable, const Module* module) {
-    auto sema = new InferSema;
-    typetable.reset(sema);
+/*
+ * worklist
+ */
+
+void InferSema::read(Representative* repr) {
+    auto cur_item = solver().cur_item;
+    if (cur_item == no_item)
+        return;
+
+    auto& users = repr->users;
+    if (!users.empty() && users.back() == cur_item)
+        return;
+    users.push_back(cur_item);
+
+    if (repr->type->isa<UnknownType>()) {
+        if (repr->first_user == no_item)
+            repr->first_user = cur_item;
+        else
+            unite_items(repr->first_user, cur_item);
+    }
+
+    // a type like fn(?1) keeps its representative when ?1 is resolved
+    auto type = repr->type;
+    if (!type->is_known() && !type->isa<UnknownType>()) {
+        for (auto op : type->ops())
+            read(find(representative(op)));
+    }
+}
+
+void InferSema::invalidate(Representative* repr) {
+    auto& dirty = solver().dirty;
+    for (auto user : repr->users)
+        dirty[user] = true;
+    repr->users.clear();
+}
 
-    int i = 0;
-    for (;sema->todo_; ++i) {
-        sema->todo_ = false;
-        sema->infer(module);
+const Type*& InferSema::update(const Type*& slot, const Type* type) {
+    if (slot != type) { // only write if necessary - see find_type
+        if (slot != nullptr) {
+            // an old type which isn't a root anymore has already invalidated its readers when it was merged
+            auto repr = representative(slot);
+            if (repr->parent == repr)
+                invalidate(repr);
+        }
+        slot = type;
     }
+    return slot;
+}
+
+void InferSema::run(const Module* module) {
+    auto&& items = module->items();
+    auto num = items.size();
+    Solver main(num);
+    THORIN_PUSH(Solver::current(), &main);
+    item_groups_.resize(num);
+    std::iota(item_groups_.begin(), item_groups_.end(), 0);
+
+    // unreachable items are neither inferred nor checked in lazy mode
+    std::vector<bool> active(num);
+    for (size_t i = 0; i != num; ++i)
+        active[i] = !session().lazy_sema || module->is_reachable(items[i].get());
+
+    for (size_t i = 0; i != num; ++i) {
+        if (active[i]) {
+            THORIN_PUSH(main.cur_item, i);
+            infer_head(items[i].get());
+        }
+    }
+
+    // whether an item is independent is decided right before its body would be inferred sequentially
+    // - the items before might still settle the types it uses
+    bool parallel = session().parallel_infer && num_threads() > 1;
+    std::vector<bool> concurrent(num);
+    for (size_t i = 0; i != num; ++i) {
+        if (!active[i]) continue;
+        if (parallel && !main.dirty[i] && is_independent(items[i].get())) {
+            concurrent[i] = true;
+        } else {
+            THORIN_PUSH(main.cur_item, i);
+            infer(items[i].get());
+        }
+    }
+
+    num_infer_iterations_ = fixpoint(items);
+    if (std::find(concurrent.begin(), concurrent.end(), true) != concurrent.end())
+        infer_concurrently(items, concurrent);
+
+    num_representatives_ += main.pool.size();
+    num_infer_visits_ += main.num_visits;
+    for (size_t i = 0; i != num; ++i)
+        num_infer_groups_ += active[i] && item_group(i) == i;
+}
+
+size_t InferSema::fixpoint(const Items& items) {
+    auto& s = solver();
+    size_t num_rounds = 1;
+    for (; std::find(s.dirty.begin(), s.dirty.end(), true) != s.dirty.end(); ++num_rounds) {
+        auto dirty = s.dirty;
+        s.dirty.assign(items.size(), false);
+
+        for (size_t i = 0, e = items.size(); i != e; ++i) {
+            if (dirty[i]) {
+                THORIN_PUSH(s.cur_item, i);
+                infer_head(items[i].get());
+                infer(items[i].get());
+            }
+        }
+    }
+    return num_rounds;
+}
+
+bool InferSema::is_independent(const Item* item) {
+    if (!item->isa<FnDecl>() || !is_settled(item))
+        return false;
 
-    //DLOG("iterations needed for type inference: {}", i);
+    for (auto use : item->uses()) {
+        if (!is_settled(use))
+            return false;
+        if (auto struct_decl = use->isa<StructDecl>()) {
+            for (size_t i = 0, e = struct_decl->num_field_decls(); i != e; ++i) {
+                if (!is_settled(struct_decl->field_decl(i)))
+                    return false;
+            }
+        } else if (auto enum_decl = use->isa<EnumDecl>()) {
+            for (size_t i = 0, e = enum_decl->num_option_decls(); i != e; ++i) {
+                if (!is_settled(enum_decl->option_decl(i)))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+void InferSema::infer_concurrently(const Items& items, const std::vector<bool>& todo) {
+    std::vector<size_t> indices;
+    for (size_t i = 0, e = items.size(); i != e; ++i) {
+        if (todo[i])
+            indices.push_back(i);
+    }
+
+    struct Task {
+        Arena arena; // must outlive the items
+        std::vector<ASTNode*> nodes;
+        std::exception_ptr exception;
+        size_t num_rounds = 0;
+        size_t num_visits = 0;
+        size_t num_representatives = 0;
+    };
+
+    // a few tasks per thread balance the load; each one gets a contiguous range of the items
+    size_t num_tasks = std::min(indices.size(), 4 * num_threads());
+    std::vector<std::unique_ptr<Task>> tasks;
+    for (size_t t = 0; t != num_tasks; ++t)
+        tasks.emplace_back(std::make_unique<Task>());
+
+    set_shared(true);
+    parallel_for(num_tasks, [&] (size_t t) {
+        auto& task = *tasks[t];
+        // a task sees few types besides the settled ones of the items it infers
+        Solver solver(items.size(), true);
+        THORIN_PUSH(Solver::current(), &solver);
+        ArenaScope arena_scope(task.arena);
+        THORIN_PUSH(ASTNode::unnumbered(), &task.nodes);
+        try {
+            for (size_t j = t * indices.size() / num_tasks, e = (t + 1) * indices.size() / num_tasks; j != e; ++j) {
+                THORIN_PUSH(solver.cur_item, indices[j]);
+                infer(items[indices[j]].get());
+            }
+            task.num_rounds = fixpoint(items);
+        } catch (...) {
+            task.exception = std::current_exception();
+        }
+        task.num_visits = solver.num_visits;
+        task.num_representatives = solver.pool.size();
+    });
+    set_shared(false);
+
+    // merge in order as if the items had been inferred one after another; the nodes are part of the AST in any case
+    std::exception_ptr exception;
+    for (auto&& task : tasks) {
+        ASTNode::number(task->nodes);
+        Arena::current()->adopt(task->arena);
+        num_infer_iterations_ = std::max(num_infer_iterations_, task->num_rounds);
+        num_infer_visits_ += task->num_visits;
+        num_representatives_ += task->num_representatives;
+        if (task->exception && !exception)
+            exception = task->exception;
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void type_inference(std::unique_ptr<TypeTable>& typetable, const Module* module) {
+    if (typetable == nullptr)
+        typetable.reset(new InferSema);
+    static_cast<InferSema*>(typetable.get())->run(module);
 }
 
 //------------------------------------------------------------------------------
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "impala/ast.h"
 #include "impala/impala.h"
 
@@ -48,6 +50,7 @@ private:
 
 public: // HACK
     int lambda_depth_ = 0;
+    const Item* cur_item_ = nullptr; ///< top-level item currently bound
 };
 
 //------------------------------------------------------------------------------
@@ -59,7 +62,13 @@ const Decl* NameSema::lookup(const ASTNode* n, Symbol symbol) {
         auto decl = symbol2decl_.lookup(symbol);
         if (!decl)
             error(n, "'{}' not found in current scope", symbol);
-        return *decl;
+        else if (cur_item_ != nullptr && (*decl)->isa<Item>()) {
+            auto& uses = cur_item_->uses_;
+            auto item = (*decl)->as<Item>();
+            if (std::find(uses.begin(), uses.end(), item) == uses.end())
+                uses.push_back(item);
+        }
+        return decl ? *decl : nullptr;
     } else {
         error(n, "identifier '_' is reserved for anonymous declarations");
         return nullptr;
@@ -180,13 +189,19 @@ void ModuleDecl::bind(NameSema& ) const {}
 
 void Module::bind(NameSema& sema) const {
     sema.push_scope();
+    if (library()) { // its bodies are bound already
+        for (auto&& item : library()->items())
+            sema.bind_head(item.get());
+    }
     for (auto&& item : items()) {
         sema.bind_head(item.get());
         if (item->is_named_decl())
             symbol2item_[item->symbol()] = item.get();
     }
-    for (auto&& item : items())
+    for (auto&& item : items()) {
+        THORIN_PUSH(sema.cur_item_, item.get());
         item->bind(sema);
+    }
     sema.pop_scope();
 }
 
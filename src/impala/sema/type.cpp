@@ -253,37 +253,69 @@ Stream& TypeBase<TypeTable>::stream(Stream& s) const {
 //------------------------------------------------------------------------------
 
 TypeTable::TypeTable()
-    : unit_(unify(new TupleType(*this, {})))
-    , type_noret_(unify(new NoRetType(*this)))
-    , type_error_(unify(new TypeError(*this)))
-#define IMPALA_TYPE(itype, atype) , itype##_(unify(new PrimType(*this, PrimType_##itype)))
+    : unit_(unify(create<TupleType>(Types())))
+    , type_noret_(unify(create<NoRetType>()))
+    , type_error_(unify(create<TypeError>()))
+#define IMPALA_TYPE(itype, atype) , itype##_(unify(create<PrimType>(PrimType_##itype)))
 #include "impala/tokenlist.h"
 {}
 
 const Type* TypeTable::app(const Type* callee, const Type* op) {
-    auto app = unify(new App(*this, callee, op));
+    auto key = std::make_pair(callee, op);
+    {
+        auto guard = lock();
+        auto i = apps_.find(key);
+        if (i != apps_.end()) {
+            ++num_app_hits_;
+            return i->second;
+        }
+        ++num_app_misses_;
+    }
 
-    if (auto cache = app->cache_)
-        return cache;
-    if (auto lambda = app->callee()->isa<Lambda>()) {
+    // the reduction creates types itself; hash-consing yields the same result if another thread got here first
+    const Type* result;
+    if (auto lambda = callee->isa<Lambda>()) {
         Type2Type map;
-        return app->cache_ = lambda->body()->reduce(1, op, map);
+        result = lambda->body()->reduce(1, op, map);
     } else {
-        return app->cache_ = app;
+        result = make<App>(callee, op);
     }
 
-    return app;
+    auto guard = lock();
+    return apps_[key] = result;
+}
+
+TypeTable::Checkpoint TypeTable::checkpoint() const {
+    return {TypeTableBase<Type>::checkpoint(), num_infer_iterations_, num_infer_visits_, num_representatives_, num_infer_groups_,
+            num_app_hits_, num_app_misses_};
+}
+
+void TypeTable::rollback(const Checkpoint& checkpoint) {
+    for (auto i = apps_.begin(); i != apps_.end();) {
+        auto gid = std::max({i->first.first->gid(), i->first.second->gid(), i->second->gid()});
+        i = gid >= checkpoint.gid_counter ? apps_.erase(i) : std::next(i);
+    }
+    TypeTableBase<Type>::rollback(checkpoint);
+
+    num_infer_iterations_ = checkpoint.num_infer_iterations;
+    num_infer_visits_     = checkpoint.num_infer_visits;
+    num_representatives_  = checkpoint.num_representatives;
+    num_infer_groups_     = checkpoint.num_infer_groups;
+    num_app_hits_         = checkpoint.num_app_hits;
+    num_app_misses_       = checkpoint.num_app_misses;
 }
 
 const StructType* TypeTable::struct_type(const StructDecl* decl, size_t size) {
-    auto type = new StructType(*this, decl, size);
+    auto guard = lock();
+    auto type = create<StructType>(decl, size);
     const auto& p = types_.insert(type);
     assert_unused(p.second && "hash/equal broken");
     return type;
 }
 
 const EnumType* TypeTable::enum_type(const EnumDecl* decl, size_t size) {
-    auto type = new EnumType(*this, decl, size);
+    auto guard = lock();
+    auto type = create<EnumType>(decl, size);
     const auto& p = types_.insert(type);
     assert_unused(p.second && "hash/equal broken");
     return type;
@@ -308,7 +340,7 @@ const InferError* TypeTable::infer_error(const Type* dst, const Type* src) {
             return si;
     }
 
-    return unify(new InferError(*this, dst, src));
+    return make<InferError>(dst, src);
 }
 
 }
@@ -1,6 +1,9 @@
 #ifndef IMPALA_SEMA_TYPE_H
 #define IMPALA_SEMA_TYPE_H
 
+#include <unordered_map>
+#include <utility>
+
 #include "thorin/util/array.h"
 #include "thorin/util/cast.h"
 #include "thorin/util/hash.h"
@@ -269,8 +272,6 @@ public:
 private:
     const Type* vrebuild(TypeTable& to, Types ops) const override;
 
-    mutable const Type* cache_ = nullptr;
-
     friend class TypeTable;
 };
 
@@ -464,11 +465,11 @@ class TypeTable : public TypeTableBase<Type> {
 public:
     TypeTable();
 
-    const Var* var(int depth) { return unify(new Var(*this, depth)); }
+    const Var* var(int depth) { return make<Var>(depth); }
     const Type* app(const Type* callee, const Type* op);
-    const Lambda* lambda(const Type* body, const char* name) { return unify(new Lambda(*this, body, name)); }
+    const Lambda* lambda(const Type* body, const char* name) { return make<Lambda>(body, name); }
 
-    const TupleType* tuple_type(Types ops) { assert(ops.size() != 1); return unify(new TupleType(*this, ops)); }
+    const TupleType* tuple_type(Types ops) { assert(ops.size() != 1); return make<TupleType>(ops); }
     const TupleType* unit() { return unit_; }
 
     const StructType* struct_type(const StructDecl* decl, size_t size);
@@ -477,30 +478,74 @@ public:
 #define IMPALA_TYPE(itype, atype) const PrimType* type_##itype() { return itype##_; }
 #include "impala/tokenlist.h"
     const DefiniteArrayType* definite_array_type(const Type* elem_type, uint64_t dim) {
-        return unify(new DefiniteArrayType(*this, elem_type, dim));
+        return make<DefiniteArrayType>(elem_type, dim);
     }
-    const FnType* fn_type(const Type* op) { return unify(new FnType(*this, op)); }
-    const FnType* fn_type(Types params) { return unify(new FnType(*this, params.size() == 1 ? params.front() : tuple_type(params))); }
+    const FnType* fn_type(const Type* op) { return make<FnType>(op); }
+    const FnType* fn_type(Types params) { return make<FnType>(params.size() == 1 ? params.front() : tuple_type(params)); }
     const IndefiniteArrayType* indefinite_array_type(const Type* elem_type) {
-        return unify(new IndefiniteArrayType(*this, elem_type));
+        return make<IndefiniteArrayType>(elem_type);
     }
-    const SimdType* simd_type(const Type* elem_type, uint64_t size) { return unify(new SimdType(*this, elem_type, size)); }
+    const SimdType* simd_type(const Type* elem_type, uint64_t size) { return make<SimdType>(elem_type, size); }
     const BorrowedPtrType* borrowed_ptr_type(const Type* pointee, bool mut, uint64_t addr_space) {
-        return unify(new BorrowedPtrType(*this, pointee, mut, addr_space));
+        return make<BorrowedPtrType>(pointee, mut, addr_space);
     }
     const OwnedPtrType* owned_ptr_type(const Type* pointee, uint64_t addr_space) {
-        return unify(new OwnedPtrType(*this, pointee, addr_space));
+        return make<OwnedPtrType>(pointee, addr_space);
     }
     const RefType* ref_type(const Type* pointee, bool mut, uint64_t addr_space) {
-        return unify(new RefType(*this, pointee, mut, addr_space));
+        return make<RefType>(pointee, mut, addr_space);
     }
     const NoRetType* type_noret() { return type_noret_; }
     const PrimType* prim_type(PrimTypeTag tag);
-    const UnknownType* unknown_type() { return unify(new UnknownType(*this)); }
+    const UnknownType* unknown_type() { return make<UnknownType>(); }
     const TypeError* type_error() { return type_error_; }
     const InferError* infer_error(const Type* dst, const Type* src);
 
+    size_t num_infer_iterations() const { return num_infer_iterations_; } ///< Rounds needed by @p type_inference.
+    size_t num_infer_visits() const { return num_infer_visits_; }         ///< AST nodes inferred by @p type_inference.
+    size_t num_representatives() const { return num_representatives_; }   ///< union-find nodes used by @p type_inference.
+    /// Groups of items that share no @p UnknownType during @p type_inference - see @p Session::parallel_infer.
+    size_t num_infer_groups() const { return num_infer_groups_; }
+    size_t num_app_hits() const { return num_app_hits_; }                 ///< @p app%s answered by the memo cache.
+    size_t num_app_misses() const { return num_app_misses_; }             ///< @p app%s that had to be reduced.
+
+    /// Also restores the memo cache of @p app and the counters.
+    struct Checkpoint : TypeTableBase<Type>::Checkpoint {
+        size_t num_infer_iterations, num_infer_visits, num_representatives, num_infer_groups;
+        size_t num_app_hits, num_app_misses;
+    };
+
+    Checkpoint checkpoint() const;
+    void rollback(const Checkpoint& checkpoint);
+
+protected:
+    size_t num_infer_iterations_ = 0;
+    size_t num_infer_visits_ = 0;
+    size_t num_representatives_ = 0;
+    size_t num_infer_groups_ = 0;
+
 private:
+    struct AppHash {
+        size_t operator()(std::pair<const Type*, const Type*> p) const {
+            return thorin::hash_combine(thorin::hash_begin(uint32_t(p.first->gid())), uint32_t(p.second->gid()));
+        }
+    };
+
+    /// Constructs a @p T for this table in memory from @p allocate - hand it over to @p unify or @p insert.
+    template<class T, class... Args>
+    const T* create(Args&&... args) { return new (allocate(sizeof(T), alignof(T))) T(*this, std::forward<Args>(args)...); }
+    /// @p create%s and @p unify%s a @p T under the @p lock.
+    template<class T, class... Args>
+    const T* make(Args&&... args) {
+        auto guard = lock();
+        return unify(create<T>(std::forward<Args>(args)...));
+    }
+
+    /// Memo cache of @p app keyed by callee and argument.
+    /// Types are immutable - @p UnknownType%s are resolved via union-find outside of this table - so entries never go stale.
+    std::unordered_map<std::pair<const Type*, const Type*>, const Type*, AppHash> apps_;
+    size_t num_app_hits_ = 0;
+    size_t num_app_misses_ = 0;
     const TupleType* unit_;
     const NoRetType* type_noret_;
     const TypeError* type_error_;
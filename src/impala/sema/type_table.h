@@ -1,11 +1,17 @@
 #ifndef IMPALA_SEMA_TYPE_TABLE_H
 #define IMPALA_SEMA_TYPE_TABLE_H
 
+#include <mutex>
+#include <new>
+#include <vector>
+
 #include "thorin/util/hash.h"
 #include "thorin/util/cast.h"
 #include "thorin/util/array.h"
 #include "thorin/util/stream.h"
 
+#include "impala/arena.h"
+
 namespace impala {
 
 template<class T> using ArrayRef = thorin::ArrayRef<T>;
@@ -60,8 +66,6 @@ public:
     const TypeBase* rebuild(TypeTable& to, Types ops) const;
     const TypeBase* rebuild(Types ops) const { return rebuild(table(), ops); }
 
-    static size_t gid_counter() { return gid_counter_; }
-
 protected:
     virtual hash_t vhash() const;
     virtual const TypeBase* vreduce(int, const TypeBase*, Type2Type&) const;
@@ -79,7 +83,6 @@ private:
     int tag_;
     Array<const TypeBase*> ops_;
     mutable size_t gid_;
-    static size_t gid_counter_;
 
     friend TypeTable;
 };
@@ -102,29 +105,75 @@ public:
     TypeTableBase(const TypeTableBase&) = delete;
 
     TypeTableBase() {}
-    virtual ~TypeTableBase() { for (auto type : types_) delete type; }
+    virtual ~TypeTableBase() { for (auto type : types_) type->~Type(); }
 
     const TypeSet& types() const { return types_; }
+    size_t num_type_allocations() const { return arena_.num_allocations(); } ///< Types kept in this table.
+    size_t num_type_duplicates() const { return num_type_duplicates_; }      ///< Requests answered by an existing type.
+    /// Several threads may create types while this is set; must be set while there are no other threads which use this table.
+    void set_shared(bool shared) { shared_ = shared; }
+
+    /// The types of this table at some point - see @p rollback.
+    struct Checkpoint {
+        Arena::Mark mark;
+        size_t gid_counter;
+        size_t num_type_duplicates;
+    };
+
+    Checkpoint checkpoint() const { return {arena_.mark(), gid_counter_, num_type_duplicates_}; }
+    /// Destroys all types created since @p checkpoint; no type nor AST node that is kept may refer to them anymore.
+    void rollback(const Checkpoint& checkpoint);
 
 protected:
-    const Type* unify_base(const Type* type);
-    template<class T> const T* unify(const T* type) { return unify_base(type)->template as<T>(); }
+    /// Guards the creation of types if this table is shared; a no-op otherwise.
+    std::unique_lock<std::mutex> lock() const {
+        return shared_ ? std::unique_lock<std::mutex>(mutex_) : std::unique_lock<std::mutex>();
+    }
+
+    /// Memory for a new type; see @p unify.
+    void* allocate(size_t size, size_t align) { return arena_.allocate(size, align); }
+
+    /**
+     * Hash-conses the @p type that has just been constructed in memory from @p allocate.
+     * If an equal type already exists, @p type is released again right away - it was the most recent allocation
+     * of this table, so duplicates neither consume memory nor a gid.
+     */
+    template<class T>
+    const T* unify(const T* type) {
+        auto i = types_.find(type);
+        if (i != types_.end()) {
+            type->~T();
+            arena_.free_last(const_cast<T*>(type), sizeof(T));
+            --gid_counter_;
+            ++num_type_duplicates_;
+            return (*i)->template as<T>();
+        }
+        insert(type);
+        return type;
+    }
+
     const Type* insert(const Type*);
 
     TypeSet types_;
+
+private:
+    Arena arena_;
+    size_t num_type_duplicates_ = 0;
+    size_t gid_counter_ = 1; ///< Per table so that independent @p TypeTable%s may be used concurrently.
+    bool shared_ = false;
+    mutable std::mutex mutex_;
+
+    friend Type;
 };
 
 //------------------------------------------------------------------------------
 
-template <class TypeTable>
-size_t TypeBase<TypeTable>::gid_counter_ = 1;
-
 template <class TypeTable>
 TypeBase<TypeTable>::TypeBase(TypeTable& table, int tag, Types ops)
     : table_(&table)
     , tag_(tag)
     , ops_(ops.size())
-    , gid_(gid_counter_++)
+    , gid_(table.gid_counter_++)
 {
     for (size_t i = 0, e = num_ops(); i != e; ++i) {
         if (auto op = ops[i])
@@ -188,18 +237,6 @@ bool TypeBase<TypeTable>::equal(const TypeBase* other) const {
 
 //------------------------------------------------------------------------------
 
-template <class Type>
-const Type* TypeTableBase<Type>::unify_base(const Type* type) {
-    auto i = types_.find(type);
-    if (i != types_.end()) {
-        delete type;
-        type = *i;
-        return type;
-    }
-
-    return insert(type);
-}
-
 template <class Type>
 const Type* TypeTableBase<Type>::insert(const Type* type) {
     const auto& p = types_.insert(type);
@@ -207,6 +244,24 @@ const Type* TypeTableBase<Type>::insert(const Type* type) {
     return type;
 }
 
+template <class Type>
+void TypeTableBase<Type>::rollback(const Checkpoint& checkpoint) {
+    // types only refer to older types - so none of the kept ones refers to the destroyed ones
+    std::vector<const Type*> created;
+    for (auto type : types_) {
+        if (type->gid() >= checkpoint.gid_counter)
+            created.push_back(type);
+    }
+    for (auto type : created)
+        types_.erase(type);
+    for (auto type : created)
+        type->~Type();
+
+    arena_.rewind(checkpoint.mark);
+    gid_counter_ = checkpoint.gid_counter;
+    num_type_duplicates_ = checkpoint.num_type_duplicates;
+}
+
 //------------------------------------------------------------------------------
 
 }
@@ -1,7 +1,10 @@
+#include <exception>
 #include <sstream>
+#include <vector>
 
 #include "impala/ast.h"
 #include "impala/impala.h"
+#include "impala/parallel.h"
 
 using namespace thorin;
 
@@ -63,7 +66,7 @@ public:
 
     void expect_known(const Decl* value_decl) {
         if (!value_decl->type()->is_known()) {
-            if (value_decl->symbol() == "return")
+            if (value_decl->symbol() == known_symbols().return_)
                 error(value_decl, "cannot infer a return type, maybe you forgot to mark the function with '-> !'?");
             else
                 error(value_decl, "cannot infer type for '{}'", value_decl->symbol());
@@ -110,7 +113,48 @@ public:
     const Fn* cur_fn_ = nullptr;
 };
 
-void type_analysis(const Module* module) { TypeSema().check(module); }
+/**
+ * Inference has fixed all types by now, so the items of @p module are independent of each other.
+ * With @p Session::parallel_check, they are checked concurrently; diagnostics are then buffered per item and flushed in
+ * source order.
+ */
+void type_analysis(const Module* module) {
+    auto& items = module->items();
+    size_t num = items.size();
+    std::vector<bool> active(num, true);
+    if (session().lazy_sema) {
+        for (size_t i = 0; i != num; ++i)
+            active[i] = module->is_reachable(items[i].get());
+    }
+
+    if (!session().parallel_check || num <= 1 || num_threads() <= 1) {
+        TypeSema sema;
+        for (size_t i = 0; i != num; ++i) {
+            if (active[i])
+                sema.check(items[i].get());
+        }
+        return;
+    }
+
+    std::vector<std::ostringstream> streams(num);
+    std::vector<std::exception_ptr> exceptions(num);
+    parallel_for(num, [&] (size_t i) {
+        if (!active[i])
+            return;
+        THORIN_PUSH(diagnostics(), &streams[i]);
+        try {
+            TypeSema().check(items[i].get());
+        } catch (...) {
+            exceptions[i] = std::current_exception();
+        }
+    });
+
+    for (size_t i = 0; i != num; ++i) {
+        *diagnostics() << streams[i].str();
+        if (exceptions[i])
+            std::rethrow_exception(exceptions[i]);
+    }
+}
 
 template<class T>
 TokenTag token_tag(const T* expr) { return TokenTag(expr->tag()); }
@@ -229,7 +273,8 @@ void Module::check(TypeSema& sema) const {
 
 void ExternBlock::check(TypeSema& sema) const {
     if (!abi().empty()) {
-        if (abi() != "\"C\"" && abi() != "\"device\"" && abi() != "\"thorin\"")
+        auto& known = known_symbols();
+        if (abi() != known.abi_c && abi() != known.abi_device && abi() != known.abi_thorin)
             error(this, "unknown extern specification");  // TODO: better location
     }
 
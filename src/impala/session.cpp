@@ -0,0 +1,19 @@
+#include "impala/session.h"
+
+namespace impala {
+
+Session*& Session::current() {
+    static thread_local Session* session = nullptr;
+    return session;
+}
+
+Session& session() {
+    static Session default_session;
+    if (auto cur = Session::current())
+        return *cur;
+    return default_session;
+}
+
+Stats& stats() { return session().stats; }
+
+}
@@ -0,0 +1,60 @@
+#ifndef IMPALA_SESSION_H
+#define IMPALA_SESSION_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "impala/src_loc.h"
+#include "impala/stats.h"
+
+namespace impala {
+
+/**
+ * All mutable state of one compilation: diagnostic counts, output options, @p Stats, the @p SourceMap, and the @p ASTNode id counter.
+ * Different threads may run independent @p Session%s at the same time.
+ * Code that does not set up a @p Session - see @p SessionScope - uses a process-wide default one.
+ */
+class Session {
+public:
+    Session() = default;
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    std::atomic<int> num_warnings{0};
+    std::atomic<int> num_errors{0};
+    bool fancy = false;
+    /// Only infer and check items which are @p Module::is_reachable; errors in all other items go unreported.
+    bool lazy_sema = false;
+    bool pipeline_lexer = false; ///< Lex each file on its own thread ahead of its @p Parser.
+    bool parallel_infer = false; ///< Infer independent function bodies on several threads - same types as sequentially.
+    bool parallel_check = false; ///< Check the items of a @p Module on several threads once their types are inferred.
+    Stats stats;
+    SourceMap source_map; ///< Resolves the @p SrcLoc%s of @p Token%s and @p ASTNode%s.
+    size_t ast_gid_counter = 1; ///< Only touched by the thread that drives the @p Session.
+
+    /// The @p Session set up on this thread - see @p SessionScope - or @c nullptr.
+    static Session*& current();
+};
+
+/// The @p Session::current one or the process-wide default @p Session.
+Session& session();
+
+/// Makes a @p Session the @p Session::current one on this thread during its lifetime.
+class SessionScope {
+public:
+    SessionScope(Session& session)
+        : old_(Session::current())
+    {
+        Session::current() = &session;
+    }
+    SessionScope(const SessionScope&) = delete;
+    SessionScope& operator=(const SessionScope&) = delete;
+    ~SessionScope() { Session::current() = old_; }
+
+private:
+    Session* old_;
+};
+
+}
+
+#endif
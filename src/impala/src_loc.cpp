@@ -0,0 +1,80 @@
+#include "impala/src_loc.h"
+
+#include <algorithm>
+
+#include "impala/session.h"
+
+namespace impala {
+
+SrcLoc::SrcLoc(const Loc& loc) {
+    if (loc.file.empty())
+        return;
+    auto& source_map = session().source_map;
+    file = source_map.find_or_add(loc.file);
+    auto& source_file = source_map.file(file);
+    begin = source_file.offset(loc.begin);
+    finis = source_file.offset(loc.finis);
+}
+
+Loc SrcLoc::loc() const {
+    auto& source_map = session().source_map;
+    if (file >= source_map.size())
+        return {}; // no_file - e.g. a default constructed Token
+    auto& source_file = source_map.file(file);
+    return {source_file.name(), source_file.pos(begin), source_file.pos(finis)};
+}
+
+//------------------------------------------------------------------------------
+
+std::vector<uint32_t> SourceFile::line_starts() const {
+    auto guard = lock();
+    return line_starts_;
+}
+
+void SourceFile::add_line(uint32_t offset) {
+    auto guard = lock();
+    line_starts_.push_back(offset);
+}
+
+Pos SourceFile::pos(uint32_t offset) const {
+    auto guard = lock();
+    auto i = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+    auto row = uint32_t(i - line_starts_.begin());
+    return {row, offset - line_starts_[row - 1] + 1};
+}
+
+uint32_t SourceFile::offset(Pos pos) const {
+    auto guard = lock();
+    auto row = std::min(size_t(std::max(pos.row, uint32_t(1))), line_starts_.size());
+    return line_starts_[row - 1] + std::max(pos.col, uint32_t(1)) - 1;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t SourceMap::add(std::string name, std::vector<uint32_t> line_starts) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.emplace_back(std::move(name), std::move(line_starts));
+    return uint32_t(files_.size() - 1);
+}
+
+uint32_t SourceMap::find_or_add(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = files_.size(); i-- != 0;) {
+        if (files_[i].name() == name)
+            return uint32_t(i);
+    }
+    files_.emplace_back(name, std::vector<uint32_t>());
+    return uint32_t(files_.size() - 1);
+}
+
+SourceFile& SourceMap::file(uint32_t i) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_[i];
+}
+
+size_t SourceMap::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_.size();
+}
+
+}
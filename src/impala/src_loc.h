@@ -0,0 +1,95 @@
+#ifndef IMPALA_SRC_LOC_H
+#define IMPALA_SRC_LOC_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "thorin/debug.h"
+
+namespace impala {
+
+using thorin::Loc;
+using thorin::Pos;
+
+/**
+ * Compact stand-in for a @p Loc: the index of a @p SourceFile in the @p SourceMap of the current @p Session
+ * plus the byte offsets of the first and the last character.
+ * Rows and columns are only computed from the line starts of the @p SourceFile once a @p Loc is actually needed.
+ * A default constructed @p SrcLoc refers to no file at all - see @p no_file.
+ */
+struct SrcLoc {
+    static constexpr uint32_t no_file = uint32_t(-1); ///< Never a valid index into a @p SourceMap.
+
+    SrcLoc() = default;
+    SrcLoc(uint32_t file, uint32_t begin, uint32_t finis)
+        : file(file)
+        , begin(begin)
+        , finis(finis)
+    {}
+    SrcLoc(const Loc&); ///< Registers the file of the @p Loc if it is not known yet; a @p Loc without file gets @p no_file.
+
+    SrcLoc anew_begin() const { return {file, begin, begin}; }
+    SrcLoc anew_finis() const { return {file, finis, finis}; }
+    Loc loc() const;
+
+    uint32_t file  = no_file;
+    uint32_t begin = 0;
+    uint32_t finis = 0;
+};
+
+/**
+ * Name and line starts of a file - enough to turn byte offsets into @p Pos%itions.
+ * Lines may only be added while other threads resolve positions if the file is @p shared - see <tt>-pipeline-lexer</tt>.
+ * Otherwise, there is no locking.
+ */
+class SourceFile {
+public:
+    SourceFile(std::string name, std::vector<uint32_t> line_starts)
+        : name_(std::move(name))
+        , line_starts_(std::move(line_starts))
+    {
+        if (line_starts_.empty())
+            line_starts_.push_back(0);
+    }
+
+    const std::string& name() const { return name_; }
+    bool shared() const { return shared_; }
+    /// Must be set while there are no other threads which use this @p SourceFile.
+    void set_shared(bool shared) { shared_ = shared; }
+    std::vector<uint32_t> line_starts() const;
+    void add_line(uint32_t offset); ///< A new line starts right after a newline at @p offset - 1.
+
+    Pos pos(uint32_t offset) const;
+    uint32_t offset(Pos pos) const;
+
+private:
+    std::unique_lock<std::mutex> lock() const {
+        return shared_ ? std::unique_lock<std::mutex>(mutex_) : std::unique_lock<std::mutex>();
+    }
+
+    std::string name_;
+    bool shared_ = false;
+    mutable std::mutex mutex_;
+    std::vector<uint32_t> line_starts_; ///< sorted byte offsets; the first one is always 0
+};
+
+/// All @p SourceFile%s known to a @p Session. Thread-safe; a registered @p SourceFile never moves.
+class SourceMap {
+public:
+    uint32_t add(std::string name, std::vector<uint32_t> line_starts = {});
+    /// The @p SourceFile which was added most recently under @p name; adds an empty one if there is none.
+    uint32_t find_or_add(const std::string& name);
+    SourceFile& file(uint32_t i);
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<SourceFile> files_;
+};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "impala/stats.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#ifdef __GNUG__
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+#endif
+
+namespace impala {
+
+long peak_rss() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+std::string demangle(const char* name) {
+    std::string result = name;
+#ifdef __GNUG__
+    int status = 0;
+    std::unique_ptr<char, void(*)(void*)> demangled(abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+    if (status == 0)
+        result = demangled.get();
+#endif
+    for (auto prefix : {"class ", "struct ", "impala::"}) { // MSVC yields "class impala::Foo"
+        auto n = std::char_traits<char>::length(prefix);
+        if (result.compare(0, n, prefix) == 0)
+            result.erase(0, n);
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+void Stats::add_pass(const std::string& name, double wall, double cpu, long rss) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto i = std::find_if(passes_.begin(), passes_.end(), [&] (const Pass& pass) { return pass.name == name; });
+    if (i == passes_.end())
+        i = passes_.insert(passes_.end(), Pass{name});
+    i->wall += wall;
+    i->cpu  += cpu;
+    i->rss  += rss;
+}
+
+void Stats::count(const std::string& name, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto i = std::find_if(counters_.begin(), counters_.end(), [&] (const Counter& counter) { return counter.name == name; });
+    if (i == counters_.end())
+        i = counters_.insert(counters_.end(), Counter{name});
+    i->value += n;
+}
+
+void Stats::dump(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto flags = os.flags();
+
+    if (time_passes && !passes_.empty()) {
+        double wall = 0.0, cpu = 0.0;
+        for (auto&& pass : passes_) {
+            wall += pass.wall;
+            cpu  += pass.cpu;
+        }
+
+        os << "=== pass execution times ===" << std::endl;
+        os << std::setw(12) << "wall (s)" << std::setw(12) << "cpu (s)" << std::setw(14) << "peak rss (KiB)" << "  pass" << std::endl;
+        os << std::fixed << std::setprecision(4);
+        for (auto&& pass : passes_) {
+            os << std::setw(12) << pass.wall << std::setw(12) << pass.cpu << std::setw(14) << ('+' + std::to_string(pass.rss))
+               << "  " << pass.name << std::endl;
+        }
+        os << std::setw(12) << wall << std::setw(12) << cpu << std::setw(14) << peak_rss() << "  total" << std::endl;
+        os.flags(flags);
+    }
+
+    if (counters && !counters_.empty()) {
+        os << "=== statistics ===" << std::endl;
+        for (auto&& counter : counters_)
+            os << std::setw(12) << counter.value << "  " << counter.name << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+PassTimer::PassTimer(std::string name)
+    : name_(std::move(name))
+    , enabled_(stats().time_passes)
+{
+    if (enabled_) {
+        rss_  = peak_rss();
+        cpu_  = std::clock();
+        wall_ = std::chrono::steady_clock::now();
+    }
+}
+
+PassTimer::~PassTimer() {
+    if (enabled_) {
+        auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_).count();
+        auto cpu  = double(std::clock() - cpu_) / CLOCKS_PER_SEC;
+        stats().add_pass(name_, wall, cpu, peak_rss() - rss_);
+    }
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef IMPALA_STATS_H
+#define IMPALA_STATS_H
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace impala {
+
+/**
+ * Per-phase timings (see <tt>-time-passes</tt>) and counters (see <tt>-stats</tt>) of a compiler run.
+ * Nothing is recorded unless the corresponding flag is enabled.
+ */
+class Stats {
+public:
+    struct Pass {
+        std::string name;
+        double wall = 0.0; ///< seconds
+        double cpu  = 0.0; ///< seconds
+        long   rss  = 0;   ///< growth of the peak resident set size in KiB
+    };
+
+    struct Counter {
+        std::string name;
+        size_t value = 0;
+    };
+
+    bool time_passes = false;
+    bool counters = false;
+
+    /// Adds a measurement to the @p Pass @p name; repeated passes accumulate. Thread-safe.
+    void add_pass(const std::string& name, double wall, double cpu, long rss);
+    /// Adds @p n to the @p Counter @p name; counters are listed in order of their first occurrence. Thread-safe.
+    void count(const std::string& name, size_t n = 1);
+    void dump(std::ostream& = std::cerr) const;
+
+    const std::vector<Pass>& passes() const { return passes_; }
+    const std::vector<Counter>& counter_list() const { return counters_; }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Pass> passes_;
+    std::vector<Counter> counters_;
+};
+
+Stats& stats(); ///< The @p Stats of the current @p Session.
+
+/// Peak resident set size of this process in KiB or 0 if this is not available.
+long peak_rss();
+
+/// Human-readable name of the C++ type with the mangled name @p name; the @c impala:: prefix is stripped.
+std::string demangle(const char* name);
+
+/// Measures wall time, CPU time, and peak-RSS growth of its scope as @p Pass @p name if <tt>-time-passes</tt> is enabled.
+class PassTimer {
+public:
+    PassTimer(std::string name);
+    ~PassTimer();
+
+private:
+    std::string name_;
+    bool enabled_;
+    std::chrono::steady_clock::time_point wall_;
+    std::clock_t cpu_;
+    long rss_;
+};
+
+}
+
+#endif
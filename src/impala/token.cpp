@@ -1,9 +1,16 @@
 #include "impala/token.h"
 
 #include <algorithm>
+#include <array>
 #include <cerrno>
+#include <charconv>
+#include <cstdint>
 #include <cstdlib>
+#include <iterator>
 #include <limits>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
 
 #include "thorin/util/cast.h"
 
@@ -13,22 +20,52 @@ using namespace thorin;
 
 namespace impala {
 
-Token::Token(Loc loc, Tag tok)
+Symbol intern(const char* str) {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    return Symbol(str);
+}
+
+KnownSymbols::KnownSymbols()
+    : empty(intern(""))
+    , underscore(intern("_"))
+    , main(intern("main"))
+    , lambda(intern("lambda"))
+    , return_(intern("return"))
+    , continue_(intern("continue"))
+    , break_(intern("break"))
+    , abi_c(intern("\"C\""))
+    , abi_device(intern("\"device\""))
+    , abi_thorin(intern("\"thorin\""))
+{}
+
+const KnownSymbols& known_symbols() {
+    static const KnownSymbols symbols;
+    return symbols;
+}
+
+static const std::vector<Symbol>& tok2sym();
+
+Token::Token(SrcLoc loc, Tag tok)
     : loc_(loc)
-    , symbol_(tok2sym_[tok])
     , tag_(tok)
+    , symbol_(tok2sym()[tok])
 {}
 
-Token::Token(Loc loc, const std::string& str)
+Token::Token(SrcLoc loc, const std::string& str)
     : loc_(loc)
-    , symbol_(str)
+    , tag_(keyword(str))
+    , symbol_(intern(str))
 {
     assert(!str.empty());
-    auto i = keywords_.find(str);
-    if (i == keywords_.end())
-        tag_ = Token::ID;
-    else
-        tag_ = i->second;
+}
+
+Token::Token(SrcLoc loc, Tag tag, const std::string& str)
+    : loc_(loc)
+    , tag_(tag)
+    , symbol_(intern(str))
+{
+    assert(tag == LIT_str || tag == LIT_char);
 }
 
 template<class T, class V>
@@ -36,75 +73,94 @@ static bool inrange(V val) {
     return std::numeric_limits<T>::lowest() <= val && val <= std::numeric_limits<T>::max();
 }
 
-Token::Token(Loc loc, Tag tag, const std::string& str)
+/*
+ * The following parse the digits in [first, last) and stop at the suffix.
+ * A literal without any digits yields 0 - the Lexer has already complained about it.
+ * They return false on overflow.
+ */
+
+template<class T>
+static bool parse_int(const char* first, const char* last, int base, T& val) {
+    val = 0;
+    return std::from_chars(first, last, val, base).ec != std::errc::result_out_of_range;
+}
+
+template<class T>
+static bool parse_float(const char* first, const char* last, int base, T& val) {
+    val = 0;
+    if (base != 10) { // e.g. 0b101f
+        uint64_t uval;
+        bool ok = parse_int(first, last, base, uval);
+        val = T(uval);
+        return ok && inrange<T>(val);
+    }
+#ifdef __cpp_lib_to_chars
+    return std::from_chars(first, last, val).ec != std::errc::result_out_of_range;
+#else
+    // no floating-point from_chars in this standard library; strto* needs a terminated copy
+    std::string str(first, last);
+    errno = 0;
+    val = std::is_same<T, float>::value ? std::strtof(str.c_str(), nullptr) : std::strtod(str.c_str(), nullptr);
+    return errno != ERANGE;
+#endif
+}
+
+Token::Token(SrcLoc loc, Tag tag, std::string_view text)
     : loc_(loc)
-    , symbol_(str)
     , tag_(tag)
+    , symbol_(known_symbols().empty)
+    , text_(text.data())
 {
-    using namespace std;
     using thorin::half;
 
-    if (tag_ == LIT_str || tag_ == LIT_char)
-        return;
+    assert(!text.empty() && text.size() == loc.finis - loc.begin + 1);
 
-    std::string literal;
+    // find out base and skip the '0b'/'0o'/'0x' prefix
     int base = 10;
-    auto begin = str.begin();
-
-    // find out base and move begin iterator to the actual number
-    if (str.size() >= 2) {
-        if (str[0] == '0') {
-            if (str[1] == 'b') {
-                base = 2;
-                begin += 2;
-            } else if (str[1] == 'o') {
-                base = 8;
-                begin += 2;
-            } else if (str[1] == 'x') {
-                base = 16;
-                begin += 2;
-            }
+    auto first = text.data(), last = text.data() + text.size();
+    if (text.size() >= 2 && text[0] == '0') {
+        switch (text[1]) {
+            case 'b': base =  2; first += 2; break;
+            case 'o': base =  8; first += 2; break;
+            case 'x': base = 16; first += 2; break;
         }
     }
 
-    // remove underscores and '0b'/'0o'/'0x' prefix if applicable
-    std::copy_if(begin, str.end(), std::back_inserter(literal), [](char c) { return c != '_'; });
-    auto nptr = &literal.front();
-
-    bool err = 0;
-    errno = 0;
-    int64_t ival; uint64_t uval; half hval; float fval; double dval;
-
-    switch (tag_) {
-        case LIT_i8: case LIT_i16: case LIT_i32: case LIT_i64:
-                      ival = strtoll (nptr, 0, base);  err = errno; break;
-        case LIT_u8: case LIT_u16: case LIT_u32: case LIT_u64:
-                      uval = strtoull(nptr, 0, base);  err = errno; break;
-        case LIT_f16: hval = strtof(symbol_.c_str(), 0); err = errno; break; // TODO: errno for half not correctly set
-        case LIT_f32: fval = strtof(symbol_.c_str(), 0); err = errno; break;
-        case LIT_f64: dval = strtod(symbol_.c_str(), 0); err = errno; break;
-        default: THORIN_UNREACHABLE;
+    // remove underscores - only these literals need a copy
+    std::string literal;
+    if (std::find(first, last, '_') != last) {
+        std::copy_if(first, last, std::back_inserter(literal), [](char c) { return c != '_'; });
+        first = literal.c_str();
+        last  = first + literal.size();
     }
 
+    bool ok;
     switch (tag_) {
-        case LIT_i8:  box_ =   int8_t(ival); err |= !inrange<  int8_t>(ival); break;
-        case LIT_i16: box_ =  int16_t(ival); err |= !inrange< int16_t>(ival); break;
-        case LIT_i32: box_ =  int32_t(ival); err |= !inrange< int32_t>(ival); break;
-        case LIT_i64: box_ =  int64_t(ival); err |= !inrange< int64_t>(ival); break;
-        case LIT_u8:  box_ =  uint8_t(uval); err |= !inrange< uint8_t>(uval); break;
-        case LIT_u16: box_ = uint16_t(uval); err |= !inrange<uint16_t>(uval); break;
-        case LIT_u32: box_ = uint32_t(uval); err |= !inrange<uint32_t>(uval); break;
-        case LIT_u64: box_ = uint64_t(uval); err |= !inrange<uint64_t>(uval); break;
-        case LIT_f16: box_ =     half(hval); err |= !inrange<    half>(hval); break;
-        case LIT_f32: box_ =    float(fval); err |= !inrange<   float>(fval); break;
-        case LIT_f64: box_ =   double(dval); err |= !inrange<  double>(dval); break;
+        case LIT_i8:  {   int8_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_i16: {  int16_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_i32: {  int32_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_i64: {  int64_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_u8:  {  uint8_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_u16: { uint16_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_u32: { uint32_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_u64: { uint64_t val; ok = parse_int(first, last, base, val); box_ = val; break; }
+        case LIT_f16: {
+            float val;
+            ok = parse_float(first, last, base, val);
+            auto hval = half(val);
+            ok &= inrange<half>(hval);
+            box_ = hval;
+            break;
+        }
+        case LIT_f32: {    float val; ok = parse_float(first, last, base, val); box_ = val; break; }
+        case LIT_f64: {   double val; ok = parse_float(first, last, base, val); box_ = val; break; }
         default: THORIN_UNREACHABLE;
     }
 
-    if (err)
+    if (!ok)
         switch (tag_) {
 #define IMPALA_LIT(itype, atype) \
-            case LIT_##itype: error(loc, "literal out of range for type '{}'", #itype); return;
+            case LIT_##itype: error(loc.loc(), "literal out of range for type '{}'", #itype); return;
 #include "impala/tokenlist.h"
         default: THORIN_UNREACHABLE;
     }
@@ -161,111 +217,145 @@ int Token::to_binop(Tag tag) {
 }
 
 /*
- * static member variables
+ * tables - all built at compile time from impala/tokenlist.h except for the Symbols
  */
 
-int Token::tok2op_[Num];
-Token::Tag2Str Token::tok2str_;
-Token::Tag2Sym Token::tok2sym_;
-Token::Sym2Tag Token::keywords_;
-Token::Sym2Tag Token::sym2lit_;
-Token::Sym2Tag Token::sym2flit_;
+static constexpr auto tok2str_ = [] {
+    std::array<const char*, Token::Num> tok2str = {};
+#define IMPALA_PREFIX(    tok, str)       tok2str[Token::tok] = str;
+#define IMPALA_POSTFIX(   tok, str)       tok2str[Token::tok] = str;
+#define IMPALA_INFIX(     tok, str, prec) tok2str[Token::tok] = str;
+#define IMPALA_INFIX_ASGN(tok, str)       tok2str[Token::tok] = str;
+#define IMPALA_MISC(      tok, str)       tok2str[Token::tok] = str;
+#define IMPALA_KEY(       tok, str)       tok2str[Token::tok] = str;
+#define IMPALA_LIT(       tok, atype)     tok2str[Token::LIT_##tok] = "<literal>";
+#define IMPALA_TYPE(itype, atype)         tok2str[Token::TYPE_##itype] = #itype;
+#include "impala/tokenlist.h"
 
-/*
- * static methods
- */
+    // type aliases
+    tok2str[Token::TYPE_i32] = "int";
+    tok2str[Token::TYPE_u32] = "uint";
+    tok2str[Token::TYPE_f16] = "half";
+    tok2str[Token::TYPE_f32] = "float";
+    tok2str[Token::TYPE_f64] = "double";
 
-TokenTag Token::sym2lit(Symbol sym) {
-    auto i = sym2lit_.find(sym);
-    if (i != sym2lit_.end())
-        return i->second;
-    return Error;
+    // special tokens
+    tok2str[Token::ID]  = "<identifier>";
+    tok2str[Token::Eof] = "<end of file>";
+    tok2str[Token::AS]  = "as";
+    tok2str[Token::MUT] = "mut";
+    return tok2str;
+}();
+
+/// Symbols of operators and punctuation; the only table which is built at runtime - once it is needed for the first time.
+static const std::vector<Symbol>& tok2sym() {
+    static const auto tok2sym = [] {
+        // not a std::array: default-constructed Symbols would go to thorin's symbol table without the lock of intern
+        std::vector<Symbol> tok2sym(Token::Num, known_symbols().empty);
+#define IMPALA_PREFIX(    tok, str)       tok2sym[Token::tok] = intern(str);
+#define IMPALA_POSTFIX(   tok, str)       tok2sym[Token::tok] = intern(str);
+#define IMPALA_INFIX(     tok, str, prec) tok2sym[Token::tok] = intern(str);
+#define IMPALA_INFIX_ASGN(tok, str)       tok2sym[Token::tok] = intern(str);
+#define IMPALA_MISC(      tok, str)       tok2sym[Token::tok] = intern(str);
+#include "impala/tokenlist.h"
+        tok2sym[Token::Eof] = intern("<end of file>");
+        return tok2sym;
+    }();
+    return tok2sym;
 }
 
-TokenTag Token::sym2flit(Symbol sym) {
-    auto i = sym2flit_.find(sym);
-    if (i != sym2flit_.end())
-        return i->second;
-    return Error;
-}
+struct Keyword {
+    std::string_view str;
+    Token::Tag tag;
+};
 
-void Token::init() {
-    /*
-     * - set pre-/in-/postfix operators
-     * - register literals
-     * - register keywords
-     * - register misc tokens
-     */
-
-    for (size_t i = 0; i < Num; ++i)
-        tok2op_[i] = None;
-
-#define IMPALA_PREFIX(    tok, str)       insert(tok, str); tok2op_[tok] |= Prefix;
-#define IMPALA_POSTFIX(   tok, str)       insert(tok, str); tok2op_[tok] |= Postfix;
-#define IMPALA_INFIX(     tok, str, prec) insert(tok, str); tok2op_[tok] |= Infix;
-#define IMPALA_INFIX_ASGN(tok, str)       insert(tok, str); tok2op_[tok] |= Infix | Asgn_Op;
-#define IMPALA_MISC(      tok, str)       insert(tok, str);
-#define IMPALA_KEY(       tok, str)       insert_key(tok, str);
-#define IMPALA_LIT(       tok, atype)     tok2str_[LIT_##tok] = Symbol("<literal>").c_str();
-#define IMPALA_TYPE(itype, atype)         insert_key(TYPE_ ## itype, #itype );
+static constexpr Keyword keywords[] = {
+#define IMPALA_KEY(tok, str)      { str, Token::tok },
+#define IMPALA_TYPE(itype, atype) { #itype, Token::TYPE_##itype },
 #include "impala/tokenlist.h"
-
     // type aliases
-    insert_key(TYPE_i32, "int");
-    insert_key(TYPE_u32, "uint");
-    insert_key(TYPE_f16, "half");
-    insert_key(TYPE_f32, "float");
-    insert_key(TYPE_f64, "double");
-
-    // literals
-    sym2lit_["i"]   = LIT_i32; sym2lit_["u"]   = LIT_u32;
-    sym2lit_["i8"]  = LIT_i8;  sym2lit_["u8"]  = LIT_u8;
-    sym2lit_["i16"] = LIT_i16; sym2lit_["u16"] = LIT_u16;
-    sym2lit_["i32"] = LIT_i32; sym2lit_["u32"] = LIT_u32;
-    sym2lit_["i64"] = LIT_i64; sym2lit_["u64"] = LIT_u64;
-
-    sym2lit_["h"]   = LIT_f16; sym2flit_["h"]   = LIT_f16;
-    sym2lit_["f16"] = LIT_f16; sym2flit_["f16"] = LIT_f16;
-    sym2lit_["f"]   = LIT_f32; sym2flit_["f"]   = LIT_f32;
-    sym2lit_["f32"] = LIT_f32; sym2flit_["f32"] = LIT_f32;
-    sym2lit_["f64"] = LIT_f64; sym2flit_["f64"] = LIT_f64;
-
+    { "int",    Token::TYPE_i32 },
+    { "uint",   Token::TYPE_u32 },
+    { "half",   Token::TYPE_f16 },
+    { "float",  Token::TYPE_f32 },
+    { "double", Token::TYPE_f64 },
     // special tokens
-    tok2str_[ID]         = Symbol("<identifier>").c_str();
-    insert(Eof, "<end of file>");
-    insert_key(AS, "as");
-    insert_key(MUT, "mut");
-}
+    { "as",     Token::AS },
+    { "mut",    Token::MUT },
+};
 
-void Token::insert_key(TokenTag tok, const char* str) {
-    Symbol s = str;
-    assert(keywords_.find(s) == keywords_.end() && "already inserted");
-    keywords_[s] = tok;
-    tok2str_ [tok] = s.c_str();
+/// Perfect for @p keywords which all have at least two characters - checked below.
+static constexpr size_t keyword_hash(std::string_view str) {
+    return (str.size() * 41 + size_t((unsigned char) str[0]) * 7 + size_t((unsigned char) str[1]) * 11 + size_t((unsigned char) str.back())) % 128;
 }
 
-Symbol Token::insert(TokenTag tok, const char* str) {
-    Symbol s = str;
-    const auto& p = tok2sym_.emplace(tok, s);
+static constexpr auto keyword_slots = [] {
+    struct {
+        std::array<int8_t, 128> slots = {};
+        bool perfect = true;
+    } result;
+    for (auto& slot : result.slots)
+        slot = -1;
+    for (size_t i = 0; i != std::size(keywords); ++i) {
+        auto& slot = result.slots[keyword_hash(keywords[i].str)];
+        result.perfect &= keywords[i].str.size() >= 2 && slot == -1;
+        slot = int8_t(i);
+    }
+    return result;
+}();
+static_assert(keyword_slots.perfect, "keyword_hash has collisions; pick other factors");
+
+struct Suffix {
+    std::string_view str;
+    Token::Tag tag;
+    bool floating;
+};
+
+static constexpr Suffix suffixes[] = {
+    { "i",   Token::LIT_i32, false }, { "u",   Token::LIT_u32, false },
+    { "i8",  Token::LIT_i8,  false }, { "u8",  Token::LIT_u8,  false },
+    { "i16", Token::LIT_i16, false }, { "u16", Token::LIT_u16, false },
+    { "i32", Token::LIT_i32, false }, { "u32", Token::LIT_u32, false },
+    { "i64", Token::LIT_i64, false }, { "u64", Token::LIT_u64, false },
+    { "h",   Token::LIT_f16, true  }, { "f16", Token::LIT_f16, true  },
+    { "f",   Token::LIT_f32, true  }, { "f32", Token::LIT_f32, true  },
+    { "f64", Token::LIT_f64, true  },
+};
+
+/*
+ * static methods
+ */
 
-#ifndef NDEBUG
-    if (!p.second) {
-        Tag   oldTok = p.first->first;
-        Symbol oldSym = p.first->second;
-        assert(s == oldSym && tok == oldTok && "inserted ambiguous duplicate");
+TokenTag Token::keyword(std::string_view str) {
+    if (str.size() >= 2) {
+        auto slot = keyword_slots.slots[keyword_hash(str)];
+        if (slot != -1 && keywords[slot].str == str)
+            return keywords[slot].tag;
     }
-#endif
+    return ID;
+}
 
-    tok2str_[tok] = s.c_str();
-    return p.first->second;
+TokenTag Token::sym2lit(std::string_view suffix) {
+    for (auto&& entry : suffixes) {
+        if (entry.str == suffix)
+            return entry.tag;
+    }
+    return Error;
+}
+
+TokenTag Token::sym2flit(std::string_view suffix) {
+    for (auto&& entry : suffixes) {
+        if (entry.floating && entry.str == suffix)
+            return entry.tag;
+    }
+    return Error;
 }
 
 //------------------------------------------------------------------------------
 
 const char* Token::tok2str(TokenTag tag) {
-    auto i = Token::tok2str_.find(tag);
-    assert(i != Token::tok2str_.end() && "must be found");
-    return Symbol(i->second).c_str();
+    assert(tok2str_[tag] != nullptr && "must be found");
+    return tok2str_[tag];
 }
 
 std::ostream& operator<<(std::ostream& os, const TokenTag& tag) { return os << Token::tok2str(tag); }
@@ -273,7 +363,7 @@ std::ostream& operator<<(std::ostream& os, const TokenTag& tag) { return os << T
 std::ostream& operator<<(std::ostream& os, const Token& tok) {
     const char* sym = tok.symbol().c_str();
     if (std::strcmp(sym, "") == 0)
-        return os << Symbol(Token::tok2str_[tok.tag()]).c_str();
+        return os << Token::tok2str(tok.tag());
     else
         return os << sym;
 }
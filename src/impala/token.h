@@ -1,19 +1,47 @@
 #ifndef IMPALA_TOKEN_H
 #define IMPALA_TOKEN_H
 
+#include <array>
 #include <ostream>
 #include <string>
+#include <string_view>
 
 #include "thorin/debug.h"
 #include "thorin/enums.h"
 #include "thorin/util/symbol.h"
 
+#include "impala/src_loc.h"
+
 namespace impala {
 
-using thorin::Loc;
-using thorin::Pos;
 using thorin::Symbol;
 
+/**
+ * Creates a @p Symbol; thorin's symbol table is not thread-safe, so this serializes concurrent @p parse%s.
+ * Never construct a @p Symbol from a string - or compare one against a string literal - in any other way.
+ */
+Symbol intern(const char* str);
+inline Symbol intern(const std::string& str) { return intern(str.c_str()); }
+
+/// The @p Symbol%s the compiler itself refers to; comparing against these does not touch thorin's symbol table.
+struct KnownSymbols {
+    KnownSymbols();
+
+    Symbol empty;
+    Symbol underscore;
+    Symbol main;
+    Symbol lambda;
+    Symbol return_;
+    Symbol continue_;
+    Symbol break_;
+    Symbol abi_c;      ///< <tt>"C"</tt> - quotation marks included
+    Symbol abi_device; ///< <tt>"device"</tt>
+    Symbol abi_thorin; ///< <tt>"thorin"</tt>
+};
+
+/// Interned once on first use.
+const KnownSymbols& known_symbols();
+
 class Token {
 public:
     enum Tag {
@@ -35,22 +63,22 @@ public:
         Num,
     };
 
-    struct TagHash {
-        static thorin::hash_t hash(Tag tag) { return thorin::hash_t(tag); }
-        static bool eq(Tag k1, Tag k2) { return k1 == k2; }
-        static Tag sentinel() { return Num; }
-    };
-
-    Token() {}
+    Token()
+        : symbol_(known_symbols().empty)
+    {}
     /// Create an operator token
-    Token(Loc loc, Tag tok);
+    Token(SrcLoc loc, Tag tok);
     /// Create an identifier or a keyword (depends on \p str)
-    Token(Loc loc, const std::string& str);
-    /// Create a literal
-    Token(Loc loc, Tag type, const std::string& str);
-
-    Loc loc() const { return loc_; }
-    Symbol symbol() const { return symbol_; }
+    Token(SrcLoc loc, const std::string& str);
+    /// Create a char or string literal
+    Token(SrcLoc loc, Tag type, const std::string& str);
+    /// Create a numeric literal from its @p text in the source - which must outlive this @p Token.
+    Token(SrcLoc loc, Tag type, std::string_view text);
+
+    Loc loc() const { return loc_.loc(); }
+    SrcLoc src_loc() const { return loc_; }
+    /// Numeric literals only intern their text when asked for their @p Symbol - the @p Parser just needs the @p box.
+    Symbol symbol() const { return text_ ? intern(std::string(text_, loc_.finis - loc_.begin + 1)) : symbol_; }
     thorin::Box box() const { return box_; }
     Tag tag() const { return tag_; }
     operator Tag() const { return tag_; }
@@ -69,13 +97,14 @@ public:
     bool is_assign()    const { return is_assign(tag_); }
     bool is_op()        const { return is_op(tag_); }
 
-    static Tag sym2lit(Symbol sym);
-    static Tag sym2flit(Symbol sym);
-    static bool is_prefix(Tag tag)  { return (tok2op_[tag] &  Prefix) != 0; }
-    static bool is_infix(Tag tag)   { return (tok2op_[tag] &   Infix) != 0; }
-    static bool is_postfix(Tag tag) { return (tok2op_[tag] & Postfix) != 0; }
-    static bool is_assign(Tag tag)  { return (tok2op_[tag] & Asgn_Op) != 0; }
-    static bool is_op(Tag tag)      { return is_prefix(tag) || is_infix(tag) || is_postfix(tag); }
+    static Tag sym2lit(std::string_view suffix);  ///< Literal for \em any (including floating) @p suffix or @c Error.
+    static Tag sym2flit(std::string_view suffix); ///< Literal for a \em floating point @p suffix or @c Error.
+    static Tag keyword(std::string_view str);     ///< Keyword @p str stands for or @c ID.
+    static constexpr bool is_prefix(Tag tag)  { return (tok2op_[tag] &  Prefix) != 0; }
+    static constexpr bool is_infix(Tag tag)   { return (tok2op_[tag] &   Infix) != 0; }
+    static constexpr bool is_postfix(Tag tag) { return (tok2op_[tag] & Postfix) != 0; }
+    static constexpr bool is_assign(Tag tag)  { return (tok2op_[tag] & Asgn_Op) != 0; }
+    static constexpr bool is_op(Tag tag)      { return is_prefix(tag) || is_infix(tag) || is_postfix(tag); }
     static bool is_rel(Tag tag);
     static Tag separate_assign(Tag tag);
     static int to_binop(Tag tag);
@@ -87,34 +116,28 @@ public:
     bool operator!=(const Token& t) const { return tag_ != t; }
 
 private:
-    static void init();
-    static Symbol insert(Tag tok, const char* str);
-    static void insert_key(Tag tok, const char* str);
-
-    Loc loc_;
-    Symbol symbol_;
+    SrcLoc loc_;
     Tag tag_;
+    Symbol symbol_;
+    const char* text_ = nullptr; ///< of a numeric literal whose @p symbol_ is not interned yet; spans @p loc_
     thorin::Box box_;
 
-    typedef thorin::HashMap<Symbol, Tag> Sym2Tag;
-    typedef thorin::HashMap<Tag, const char*, TagHash> Tag2Str;
-    typedef thorin::HashMap<Tag, Symbol, TagHash> Tag2Sym;
-    static int tok2op_[Num];
-    static Tag2Str tok2str_; // TODO do we need this thing?
-    static Tag2Sym tok2sym_;
-    static Sym2Tag keywords_;
-    static Sym2Tag sym2lit_; ///< Table of \em all (including floating) suffixes for literals.
-    static Sym2Tag sym2flit_;///< Table of suffixes for \em floating point literals.
-
-    friend void init();
+    static constexpr std::array<int, Num> tok2op_ = [] {
+        std::array<int, Num> tok2op = {};
+#define IMPALA_PREFIX(    tok, str)       tok2op[tok] |= Prefix;
+#define IMPALA_POSTFIX(   tok, str)       tok2op[tok] |= Postfix;
+#define IMPALA_INFIX(     tok, str, prec) tok2op[tok] |= Infix;
+#define IMPALA_INFIX_ASGN(tok, str)       tok2op[tok] |= Infix | Asgn_Op;
+#include "impala/tokenlist.h"
+        return tok2op;
+    }();
+
     friend std::ostream& operator<<(std::ostream& os, const Token& tok);
     friend std::ostream& operator<<(std::ostream& os, const Tag&  tok);
 };
 
 typedef Token::Tag TokenTag;
 
-//------------------------------------------------------------------------------
-
 std::ostream& operator<<(std::ostream& os, const Token& tok);
 std::ostream& operator<<(std::ostream& os, const TokenTag& tok);
 
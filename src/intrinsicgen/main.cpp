@@ -5,6 +5,7 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Type.h>
 
+#include "impala/arena.h"
 #include "impala/ast.h"
 #include "impala/impala.h"
 
@@ -20,6 +21,8 @@ const impala::Type* llvm2impala(impala::TypeTable&, llvm::Type*);
 
 int main() {
     impala::init();
+    impala::Arena arena;
+    impala::ArenaScope arena_scope(arena);
     std::unique_ptr<impala::TypeTable> typetable;
 
     auto module = std::make_unique<impala::Module>("dummy.impala");
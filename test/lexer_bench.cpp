@@ -0,0 +1,60 @@
+// Lexes a generated source of the given size (default: 100 MB) that is dominated by comment headers, indentation and
+// long identifiers, and reports the lexer throughput in MB/s - the best of a few runs.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "impala/lexer.h"
+#include "impala/session.h"
+
+static std::string generate(size_t size) {
+    std::string src;
+    src.reserve(size + 1024);
+    for (size_t i = 0; src.size() < size; ++i) {
+        auto n = std::to_string(i);
+        src += "/*\n"
+               " * ---------------------------------------------------------------------------------------------\n"
+               " * generated kernel number " + n + " - do not edit, this file is regenerated on every build *\n"
+               " * ---------------------------------------------------------------------------------------------\n"
+               " */\n"
+               "fn very_long_generated_function_name_for_kernel_" + n + "(input_buffer_of_kernel: &[f32]) -> f32 {\n"
+               "    // accumulate all elements of the input buffer of the generated kernel number " + n + "\n"
+               "    let mut accumulated_value_of_kernel = 0.0f;\n"
+               "    for element_index_of_kernel in range(0, 1024) {\n"
+               "        accumulated_value_of_kernel += input_buffer_of_kernel(element_index_of_kernel);\n"
+               "    }\n"
+               "    accumulated_value_of_kernel\n"
+               "}\n\n";
+    }
+    return src;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 100;
+    auto src = generate(megabytes * 1024 * 1024);
+    double mb = double(src.size()) / (1024 * 1024);
+
+    double best = 0;
+    size_t num_tokens = 0;
+    for (int run = 0; run != 3; ++run) {
+        impala::Session session;
+        impala::SessionScope session_scope(session);
+        impala::Lexer lexer(src, "bench.impala");
+
+        auto start = std::chrono::steady_clock::now();
+        num_tokens = 0;
+        while (lexer.lex().tag() != impala::Token::Eof)
+            ++num_tokens;
+        auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::max(best, mb / time);
+
+        if (lexer.num_errors() != 0)
+            return EXIT_FAILURE;
+    }
+
+    std::cout << mb << " MB, " << num_tokens << " tokens: " << best << " MB/s" << std::endl;
+    return EXIT_SUCCESS;
+}
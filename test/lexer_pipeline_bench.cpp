@@ -0,0 +1,53 @@
+// Parses a generated source of the given size (default: 100 MB) once with the lexer running in lockstep with the parser
+// and once with the lexer running ahead on its own thread (-pipeline-lexer), and reports both timings.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "test_util.h"
+
+static std::string generate(size_t size) {
+    std::string src;
+    src.reserve(size + 256);
+    for (size_t i = 0; src.size() < size; ++i) {
+        auto n = std::to_string(i);
+        src += "// function number " + n + "\n"
+               "fn fun" + n + "(a: i32, b: &[f32]) -> f32 {\n"
+               "    let mut sum = 0.0f;\n"
+               "    for j in range(0, a) {\n"
+               "        sum += b(j) * 1.5e3f + (j as f32);\n"
+               "    }\n"
+               "    if sum > 0x" + n + "u64 as f32 { sum } else { -sum }\n"
+               "}\n\n";
+    }
+    return src;
+}
+
+static double run(const std::string& src, bool pipeline, size_t& num_items) {
+    TestSession test;
+    test.session.pipeline_lexer = pipeline;
+
+    auto start = std::chrono::steady_clock::now();
+    test.parse("bench.impala", src);
+    auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    num_items = impala::num_errors() == 0 ? test.items.size() : 0;
+    return time;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 100;
+    impala::init();
+
+    auto src = generate(megabytes * 1024 * 1024);
+    size_t sequential_items, pipelined_items;
+    auto sequential = run(src, false, sequential_items);
+    auto pipelined  = run(src, true,  pipelined_items);
+
+    std::cout << src.size() / (1024 * 1024) << " MB, " << sequential_items << " items" << std::endl;
+    std::cout << "  sequential: " << sequential << " s" << std::endl;
+    std::cout << "  pipelined:  " << pipelined  << " s (" << sequential / pipelined << "x)" << std::endl;
+    return sequential_items != 0 && sequential_items == pipelined_items ? EXIT_SUCCESS : EXIT_FAILURE;
+}
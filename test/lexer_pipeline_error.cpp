@@ -0,0 +1,23 @@
+// Parses a module with -pipeline-lexer that stops being a list of items right at the start while far more tokens than
+// fit into the pipe between lexer and parser follow, and checks that the error is reported instead of hanging.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "test_util.h"
+
+int main() {
+    impala::init();
+
+    std::string src = "fn f() -> i32 { 23 }\nlet x = 42;\n";
+    for (int i = 0; i != 10000; ++i)
+        src += "fn g" + std::to_string(i) + "() {}\n"; // 7 tokens each
+
+    TestSession test;
+    test.session.pipeline_lexer = true;
+    test.parse("error.impala", src);
+
+    std::cout << test.diagnostics.str();
+    return impala::num_errors() == 1 && test.items.size() == 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+
+# Emits each test file with all code generators, once one after another and once with -parallel-codegen, and compares
+# the files they write.
+
+import filecmp
+import os
+import shutil
+import subprocess
+import sys
+
+
+OUTPUTS = ['-emit-c', '-emit-llvm']
+
+
+def emit(impala, testfile, temp, flags, timeout):
+    shutil.rmtree(temp, ignore_errors=True)
+    os.makedirs(temp)
+    base = os.path.splitext(os.path.basename(testfile))[0]
+    args = [impala, os.path.abspath(testfile), '-o', base] + OUTPUTS + flags
+    try:
+        completed = subprocess.run(args, cwd=temp, timeout=timeout, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    except subprocess.TimeoutExpired:
+        print('Running', ' '.join(args), 'timed out after', timeout, 'seconds')
+        return None, None, None
+    files = sorted(name for name in os.listdir(temp) if name.startswith(base + '.'))
+    return completed.returncode, files, str(completed.stdout, 'utf-8', 'ignore')
+
+
+def is_broken(testfile):
+    with open(testfile) as file:
+        tokens = file.readline().split()
+    return 'broken' in tokens or 'broken:' + sys.platform in tokens
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser(formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('testdir',                 help='directory with the test files',   type=str)
+    parser.add_argument('-i', '--impala',          help='path to impala',                  type=str, required=True)
+    parser.add_argument(      '--temp',            help='path to temp dir',                type=str, default=os.getcwd())
+    parser.add_argument('-t', '--compile-timeout', help='timeout for compiling test case', type=int, default=60)
+    args = parser.parse_args()
+
+    num_files = 0
+    failures = []
+    for testfile in sorted(os.listdir(args.testdir)):
+        testfile = os.path.join(args.testdir, testfile)
+        if not testfile.endswith('.impala') or is_broken(testfile):
+            continue
+        num_files += 1
+
+        name = os.path.splitext(os.path.basename(testfile))[0]
+        sequential = os.path.join(args.temp, 'parallel_codegen', 'sequential', name)
+        parallel   = os.path.join(args.temp, 'parallel_codegen', 'parallel',   name)
+        seq_code, seq_files, _ = emit(args.impala, testfile, sequential, [], args.compile_timeout)
+        par_code, par_files, par_log = emit(args.impala, testfile, parallel, ['-parallel-codegen'], args.compile_timeout)
+
+        if seq_code is None or par_code is None:
+            failures.append(testfile + ': timeout')
+        elif seq_code != par_code:
+            failures.append('{}: exit code {} vs {} with -parallel-codegen\n{}'.format(testfile, seq_code, par_code, par_log))
+        elif seq_files != par_files:
+            failures.append('{}: wrote {} vs {} with -parallel-codegen'.format(testfile, seq_files, par_files))
+        else:
+            _, mismatch, errors = filecmp.cmpfiles(sequential, parallel, seq_files, shallow=False)
+            for file in mismatch + errors:
+                failures.append('{}: {} differs with -parallel-codegen'.format(testfile, file))
+
+    for failure in failures:
+        print(failure)
+    print(num_files, 'files:', len(failures), 'mismatches')
+    sys.exit(1 if failures else 0)
@@ -0,0 +1,43 @@
+// Checks that -parallel-infer yields the same diagnostics, the same annotated AST, and the same Thorin program as the
+// sequential type inference for all Impala files in the given directories - except those flagged as broken.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "test_util.h"
+
+static Outcome run(const TestFile& file, bool parallel) {
+    TestSession test;
+    test.session.parallel_infer = parallel;
+    test.parse(file.name, file.data);
+    bool result = test.check();
+
+    thorin::World world(file.name);
+    if (result)
+        impala::emit(world, test.module.get());
+    return {result, test.diagnostics.str(), test.annotated(), world.to_string()};
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " dir..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t num_files = 0, num_mismatches = 0;
+    for (int i = 1; i != argc; ++i) {
+        for (auto&& file : read_test_files(argv[i])) {
+            auto sequential = run(file, false);
+            auto parallel   = run(file, true);
+            ++num_files;
+            if (parallel != sequential) {
+                std::cerr << "mismatch for " << file.name << std::endl;
+                ++num_mismatches;
+            }
+        }
+    }
+
+    std::cout << num_files << " files: " << num_mismatches << " mismatches" << std::endl;
+    return num_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
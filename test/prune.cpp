@@ -0,0 +1,46 @@
+// Checks that emission with pruning skips exactly the function 'unused' of codegen/prune_unreachable.impala and that
+// nothing is skipped without pruning - the JIT's default.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "impala/stats.h"
+
+#include "test_util.h"
+
+/// Number of items skipped by @p impala::emit or -1 on errors.
+static long num_pruned(const std::string& name, const std::string& data, bool prune) {
+    TestSession test;
+    impala::stats().counters = true;
+    test.parse(name, data);
+    if (!test.check()) {
+        std::cerr << test.diagnostics.str();
+        return -1;
+    }
+
+    thorin::World world(name);
+    impala::emit(world, test.module.get(), prune);
+    for (auto&& counter : impala::stats().counter_list()) {
+        if (counter.name == "items pruned before emission")
+            return long(counter.value);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " prune_unreachable.impala" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto data = read_file(argv[1]);
+    impala::init();
+
+    auto pruned = num_pruned(argv[1], data, true);
+    auto kept   = num_pruned(argv[1], data, false);
+    // once 'unused' is referenced, nothing may be pruned anymore
+    auto used   = num_pruned(argv[1], data + "extern fn use_unused() -> i32 { unused(1) }\n", true);
+    std::cout << "pruned: " << pruned << ", without pruning: " << kept << ", with 'unused' in use: " << used << std::endl;
+    return pruned == 1 && kept == 0 && used == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+// Compiles the same Impala files through the JIT entry point on several threads at once
+// and checks that every concurrent compilation behaves exactly like a sequential one:
+// same result, same diagnostics, and the same emitted Thorin program. Files flagged as broken are skipped.
+// Each file is compiled on its own and after a library file which the JIT keeps checked across calls.
+// Build with -DIMPALA_SANITIZE_THREAD=ON to run this under ThreadSanitizer.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+bool compile(const std::vector<std::string>&, const std::vector<std::string>&, thorin::World&, std::ostream&);
+
+/// Names which do not occur in any test file.
+static const char* library =
+    "struct SessionStressPair { a: i32, b: i32 }\n"
+    "fn session_stress_sum(p: SessionStressPair) -> i32 { p.a + p.b }\n";
+
+static Outcome run(const std::string& name, const std::string& data, bool with_library) {
+    thorin::World world(name);
+    std::ostringstream diagnostics;
+    bool result = with_library ? compile({"session_stress_library.impala", name}, {library, data}, world, diagnostics)
+                               : compile({name}, {data}, world, diagnostics);
+    return {result, diagnostics.str(), {}, world.to_string()};
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " dir [threads] [rounds]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t num_threads = argc > 2 ? std::stoul(argv[2]) : std::max(4u, std::thread::hardware_concurrency());
+    size_t num_rounds  = argc > 3 ? std::stoul(argv[3]) : 2;
+
+    auto files = read_test_files(argv[1]);
+    std::vector<Outcome> expected[2];
+    for (bool with_library : {false, true}) {
+        for (auto&& file : files)
+            expected[with_library].push_back(run(file.name, file.data, with_library));
+    }
+
+    std::vector<size_t> failures(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t != num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            // start at different files so that different compilations overlap
+            for (size_t r = 0; r != num_rounds; ++r) {
+                for (size_t j = 0, e = files.size(); j != e; ++j) {
+                    auto i = (j + t * e / num_threads) % e;
+                    bool with_library = (i + t + r) % 2 != 0;
+                    auto outcome = run(files[i].name, files[i].data, with_library);
+                    auto& expect = expected[with_library][i];
+                    if (outcome != expect) {
+                        std::cerr << "thread " << t << ": mismatch for " << files[i].name << (with_library ? " with library" : "")
+                                  << (outcome.result != expect.result ? " (result)" : "")
+                                  << (outcome.diagnostics != expect.diagnostics ? " (diagnostics)" : "")
+                                  << (outcome.program != expect.program ? " (program)" : "") << std::endl;
+                        ++failures[t];
+                    }
+                }
+            }
+        });
+    }
+    for (auto&& thread : threads)
+        thread.join();
+
+    size_t num_failures = 0;
+    for (auto n : failures)
+        num_failures += n;
+    std::cout << files.size() << " files, " << num_threads << " threads, " << num_rounds << " rounds: "
+              << num_failures << " mismatches" << std::endl;
+    return num_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+#ifndef IMPALA_TEST_UTIL_H
+#define IMPALA_TEST_UTIL_H
+
+// Shared by the C++ tests and benchmarks in this directory.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "thorin/world.h"
+
+#include "impala/arena.h"
+#include "impala/ast.h"
+#include "impala/impala.h"
+
+/// How a compilation went - whatever the test compares.
+struct Outcome {
+    bool result = false;
+    std::string diagnostics;
+    std::string annotated;
+    std::string program;
+
+    bool operator==(const Outcome& other) const {
+        return result == other.result && diagnostics == other.diagnostics
+            && annotated == other.annotated && program == other.program;
+    }
+    bool operator!=(const Outcome& other) const { return !(*this == other); }
+};
+
+/// Is @p data flagged as broken in its first line like <tt>// codegen broken</tt>? See perform.py.
+inline bool is_broken(const std::string& data) {
+    return data.substr(0, data.find('\n')).find("broken") != std::string::npos;
+}
+
+inline std::string read_file(const std::filesystem::path& path) {
+    std::ifstream stream(path);
+    return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+}
+
+struct TestFile {
+    std::string name;
+    std::string data;
+};
+
+/// All Impala files in @p dir but those flagged as broken, sorted by name.
+inline std::vector<TestFile> read_test_files(const std::filesystem::path& dir) {
+    std::vector<TestFile> files;
+    for (auto&& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() != ".impala")
+            continue;
+        auto data = read_file(entry.path());
+        if (!is_broken(data))
+            files.push_back({entry.path().string(), std::move(data)});
+    }
+    std::sort(files.begin(), files.end(), [] (const TestFile& a, const TestFile& b) { return a.name < b.name; });
+    return files;
+}
+
+/**
+ * A @p impala::Session of its own with an @p impala::Arena and captured @p diagnostics - set its flags before @p parse.
+ * Must live on the stack: it makes both current on this thread.
+ */
+struct TestSession {
+    TestSession()
+        : session_scope(session)
+        , push_diagnostics(impala::diagnostics(), &diagnostics)
+        , arena_scope(arena)
+    {}
+
+    /// Parses @p data into @p items.
+    void parse(const std::string& name, const std::string& data) {
+        this->name = name;
+        impala::parse(items, data, this->name.c_str());
+    }
+
+    /// Makes the @p module of all @p items parsed so far and runs semantic analysis; returns whether there are no errors.
+    bool check() {
+        module = std::make_unique<const impala::Module>(name.c_str(), std::move(items));
+        impala::check(typetable, module.get());
+        return impala::num_errors() == 0;
+    }
+
+    /// The @p module after semantic analysis as with -emit-annotated.
+    std::string annotated() const {
+        std::ostringstream os;
+        thorin::Stream stream(os);
+        module->stream(stream);
+        return os.str();
+    }
+
+    impala::Session session;
+    impala::SessionScope session_scope;
+    std::ostringstream diagnostics;
+    impala::Push<std::ostream*> push_diagnostics;
+    impala::Arena arena;
+    impala::ArenaScope arena_scope;
+    std::string name;
+    impala::Items items;
+    std::unique_ptr<const impala::Module> module;
+    std::unique_ptr<impala::TypeTable> typetable;
+};
+
+#endif